@@ -0,0 +1,170 @@
+#include "CombatKernel.h"
+#include "Entity.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Compares exchanges per second of the SoA combat kernel against the
+// Entity object path (calculateDamage + takeDamage on heap-allocated entities).
+// Usage: combat_kernel_bench [combatants] [rounds]
+
+namespace
+{
+    const int START_HEALTH = 1000000000; // Large enough that the floor at 0 never kicks in
+
+    struct Roster
+    {
+        int health;
+        int attack;
+        int defense;
+    };
+
+    std::vector<Roster> makeRoster(std::size_t count, std::uint64_t seed)
+    {
+        RandomStream rng(seed);
+        std::vector<Roster> roster;
+        roster.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            roster.push_back({START_HEALTH, rng.uniformInt(4, 35), rng.uniformInt(1, 15)});
+        }
+        return roster;
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void report(const std::string &name, std::size_t exchanges, double seconds, double baseline)
+    {
+        double rate = exchanges / seconds;
+        std::cout << "  " << name << ": " << rate / 1e6 << " M exchanges/s";
+        if (baseline > 0.0)
+        {
+            std::cout << " (" << rate / baseline << "x object path)";
+        }
+        std::cout << "\n";
+    }
+
+    // Current object path; combat text goes to a NullSink so it is not formatted
+    double benchObjectPath(const std::vector<Roster> &attackRoster, const std::vector<Roster> &defendRoster,
+                           int rounds, long long &checksum)
+    {
+        std::vector<std::unique_ptr<Entity>> attackers;
+        std::vector<std::unique_ptr<Entity>> defenders;
+        for (const Roster &r : attackRoster)
+        {
+            attackers.push_back(std::make_unique<Entity>("Goblin", r.health, r.attack, r.defense));
+        }
+        for (const Roster &r : defendRoster)
+        {
+            defenders.push_back(std::make_unique<Entity>("Slime", r.health, r.attack, r.defense));
+        }
+
+        RandomStream rng(42);
+        NullSink sink;
+        GameOutput out(sink);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round)
+        {
+            for (std::size_t i = 0; i < attackers.size(); ++i)
+            {
+                defenders[i]->takeDamage(attackers[i]->calculateDamage(rng), out);
+            }
+        }
+        double seconds = secondsSince(start);
+
+        checksum = 0;
+        for (const auto &defender : defenders)
+        {
+            checksum += defender->getHealth();
+        }
+        return seconds;
+    }
+
+    // Returns the total time; resolveSeconds receives the part spent in resolveExchanges()
+    double benchKernel(const std::vector<Roster> &attackRoster, const std::vector<Roster> &defendRoster,
+                       int rounds, CombatKernelIsa isa, long long &checksum, double &resolveSeconds)
+    {
+        CombatantArrays attackers;
+        CombatantArrays defenders;
+        attackers.reserve(attackRoster.size());
+        defenders.reserve(defendRoster.size());
+        for (const Roster &r : attackRoster)
+        {
+            attackers.add(r.health, r.attack, r.defense);
+        }
+        for (const Roster &r : defendRoster)
+        {
+            defenders.add(r.health, r.attack, r.defense);
+        }
+
+        RandomStream rng(42);
+        std::vector<std::int32_t> rolls(attackers.size());
+
+        resolveSeconds = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round)
+        {
+            rollDamageModifiers(rng, rolls.data(), rolls.size());
+            auto resolveStart = std::chrono::steady_clock::now();
+            resolveExchanges(attackers, defenders, rolls.data(), nullptr, isa);
+            resolveSeconds += secondsSince(resolveStart);
+        }
+        double seconds = secondsSince(start);
+
+        checksum = 0;
+        for (std::int32_t health : defenders.health)
+        {
+            checksum += health;
+        }
+        return seconds;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::size_t combatants = argc > 1 ? std::stoul(argv[1]) : 4096;
+    int rounds = argc > 2 ? std::stoi(argv[2]) : 2000;
+
+    std::vector<Roster> attackRoster = makeRoster(combatants, 1);
+    std::vector<Roster> defendRoster = makeRoster(combatants, 2);
+    std::size_t exchanges = combatants * static_cast<std::size_t>(rounds);
+
+    std::cout << "⚔️ COMBAT KERNEL BENCHMARK ⚔️\n";
+    std::cout << "  " << combatants << " combatant pairs x " << rounds << " rounds\n";
+
+    long long expected = 0;
+    double objectSeconds = benchObjectPath(attackRoster, defendRoster, rounds, expected);
+    double baseline = exchanges / objectSeconds;
+    report("object path", exchanges, objectSeconds, 0.0);
+
+    bool allMatch = true;
+    for (CombatKernelIsa isa : {CombatKernelIsa::SCALAR, CombatKernelIsa::SSE41, CombatKernelIsa::AVX2})
+    {
+        if (!isCombatKernelIsaSupported(isa))
+        {
+            std::cout << "  kernel " << combatKernelIsaName(isa) << ": not supported on this CPU\n";
+            continue;
+        }
+
+        long long checksum = 0;
+        double resolveSeconds = 0.0;
+        double seconds = benchKernel(attackRoster, defendRoster, rounds, isa, checksum, resolveSeconds);
+        report(std::string("kernel ") + combatKernelIsaName(isa) + " with rolls", exchanges, seconds, baseline);
+        report(std::string("kernel ") + combatKernelIsaName(isa) + " resolve only", exchanges, resolveSeconds, baseline);
+
+        if (checksum != expected)
+        {
+            std::cout << "  ❌ kernel " << combatKernelIsaName(isa) << " disagrees with the object path\n";
+            allMatch = false;
+        }
+    }
+
+    std::cout << (allMatch ? "  ✅ all kernels match the object path" : "  ❌ mismatch") << std::endl;
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,490 @@
+#include "CombatAdvisor.h"
+#include "CombatEvents.h"
+#include "Entity.h"
+#include "Game.h"
+#include "Pathfinding.h"
+#include "Player.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Engine benchmark suite: micro-benchmarks of the hot paths and a full game
+// played from MAIN_MENU to VICTORY. Prints a table and writes the results as
+// JSON so runs can be compared over time.
+// Usage: dungeon_bench [--json <file>] [--filter <text>] [--min-time <seconds>]
+
+#ifndef DUNGEON_BENCH_BUILD_TYPE
+#define DUNGEON_BENCH_BUILD_TYPE ""
+#endif
+
+struct DungeonBenchAccess
+{
+    static void createEnemies(Game &game, int level)
+    {
+        game.currentDungeonLevel = level;
+        game.createEnemies();
+    }
+};
+
+namespace
+{
+    struct BenchResult
+    {
+        std::string name;
+        long long iterations;
+        double seconds;
+        double checksum; // Keeps the work observable so it is not optimized away
+    };
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Calls body(batch) with growing batches until minTime has passed; body
+    // returns a checksum of the work it did
+    template <typename Body>
+    BenchResult measure(const std::string &name, double minTime, Body body)
+    {
+        BenchResult result{name, 0, 0.0, 0.0};
+        long long batch = 1;
+        auto start = std::chrono::steady_clock::now();
+        while (result.seconds < minTime)
+        {
+            result.checksum += body(batch);
+            result.iterations += batch;
+            result.seconds = secondsSince(start);
+            if (batch < (1LL << 24))
+            {
+                batch *= 2;
+            }
+        }
+        return result;
+    }
+
+    // First seed (from 1) on which the greedy bot beats the boss
+    std::uint64_t findWinningSeed()
+    {
+        for (std::uint64_t seed = 1;; ++seed)
+        {
+            GreedyPolicy policy;
+            NullSink sink;
+            Game game(&policy, seed, &sink);
+            while (game.step())
+            {
+            }
+            if (game.getState() == GameState::VICTORY)
+            {
+                return seed;
+            }
+        }
+    }
+
+    // FlowField::removeGoal repairs only the tiles the goal owned. After every
+    // removal each distance must match a field built from scratch with the
+    // goals still live, and each tile's owner must be one of its nearest
+    // goals: a live goal standing on it, or the owner of a neighbour one step
+    // closer. (Between equally near goals the owner may differ from a
+    // rebuild's.) Returns the tiles compared, or -1 after printing a mismatch.
+    long long checkFlowFieldRepair()
+    {
+        const int GOALS = 12;
+        const TilePos STEPS[4] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+        long long compared = 0;
+        FlowField patched;
+        FlowField fresh;
+        for (std::uint64_t seed = 1; seed <= 60; ++seed)
+        {
+            int extent = 1 + static_cast<int>(seed % 3);
+            DungeonMap map;
+            map.reset(seed, 1 + static_cast<int>(seed % 5), extent);
+            patched.reset(map, {0, 0}, extent, extent);
+            bool live[GOALS];
+            for (int goal = 0; goal < GOALS; ++goal)
+            {
+                patched.addGoal(static_cast<std::uint16_t>(goal), map.encounterPosition(static_cast<std::size_t>(goal)));
+                live[goal] = true;
+            }
+            patched.build();
+
+            RandomStream order(seed);
+            for (int removed = 0; removed < GOALS; ++removed)
+            {
+                int goal = order.uniformInt(0, GOALS - 1);
+                while (!live[goal])
+                {
+                    goal = (goal + 1) % GOALS;
+                }
+                live[goal] = false;
+                patched.removeGoal(static_cast<std::uint16_t>(goal));
+
+                fresh.reset(map, {0, 0}, extent, extent);
+                for (int other = 0; other < GOALS; ++other)
+                {
+                    if (live[other])
+                    {
+                        fresh.addGoal(static_cast<std::uint16_t>(other), map.encounterPosition(static_cast<std::size_t>(other)));
+                    }
+                }
+                fresh.build();
+
+                for (int y = 0; y < extent * CHUNK_SIZE; ++y)
+                {
+                    for (int x = 0; x < extent * CHUNK_SIZE; ++x)
+                    {
+                        TilePos tile{x, y};
+                        std::uint32_t distance = patched.distanceAt(tile);
+                        std::uint16_t owner = patched.nearestGoal(tile);
+                        bool ownerValid = distance == FlowField::UNREACHABLE;
+                        if (distance == 0)
+                        {
+                            ownerValid = owner < GOALS && live[owner] && map.encounterPosition(owner) == tile;
+                        }
+                        else if (!ownerValid)
+                        {
+                            for (TilePos step : STEPS)
+                            {
+                                TilePos neighbour{x + step.x, y + step.y};
+                                ownerValid = ownerValid || (patched.distanceAt(neighbour) == distance - 1 &&
+                                                            patched.nearestGoal(neighbour) == owner);
+                            }
+                        }
+                        if (distance != fresh.distanceAt(tile) || !ownerValid)
+                        {
+                            std::cerr << "flow field repair differs from a rebuild: seed " << seed << ", after removing goal "
+                                      << goal << ", tile " << x << "," << y << "\n";
+                            return -1;
+                        }
+                        compared++;
+                    }
+                }
+            }
+        }
+        return compared;
+    }
+
+    // A snapshot restored into another game must continue exactly as the
+    // original: bot games are saved after a varying number of steps, loaded
+    // into a game built with a different seed, and both are played to the
+    // end, where their final snapshots must be byte for byte the same.
+    // Returns the games compared, or -1 after printing the first difference.
+    int checkSnapshotRestore()
+    {
+        const int GAMES = 500;
+        std::vector<char> saved;
+        std::vector<char> original;
+        std::vector<char> restored;
+        for (int seed = 1; seed <= GAMES; ++seed)
+        {
+            GreedyPolicy policy;
+            NullSink quiet;
+            Game game(&policy, static_cast<std::uint64_t>(seed), &quiet);
+            int steps = (seed * 37) % 160;
+            for (int i = 0; i < steps && game.step(); ++i)
+            {
+            }
+            game.saveSnapshot(saved);
+
+            Game copy(&policy, static_cast<std::uint64_t>(seed) + GAMES, &quiet);
+            if (!copy.loadSnapshot(SnapshotView(saved.data(), saved.size())))
+            {
+                std::cerr << "snapshot of seed " << seed << " after " << steps << " steps was rejected\n";
+                return -1;
+            }
+            while (game.step())
+            {
+            }
+            while (copy.step())
+            {
+            }
+            game.saveSnapshot(original);
+            copy.saveSnapshot(restored);
+            if (original != restored)
+            {
+                std::cerr << "seed " << seed << " restored after " << steps << " steps ended differently\n";
+                return -1;
+            }
+        }
+        return GAMES;
+    }
+
+    std::string jsonEscape(const std::string &text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    void writeJson(std::ostream &file, const std::vector<BenchResult> &results, double minTime)
+    {
+        file << "{\n";
+        file << "  \"suite\": \"dungeon_bench\",\n";
+        file << "  \"build_type\": \"" << jsonEscape(DUNGEON_BENCH_BUILD_TYPE) << "\",\n";
+        file << "  \"min_time_seconds\": " << minTime << ",\n";
+        file << "  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchResult &result = results[i];
+            double nanoseconds = result.seconds * 1e9 / result.iterations;
+            file << "    {\"name\": \"" << jsonEscape(result.name) << "\", "
+                 << "\"iterations\": " << result.iterations << ", "
+                 << "\"seconds\": " << result.seconds << ", "
+                 << "\"ns_per_op\": " << nanoseconds << ", "
+                 << "\"ops_per_second\": " << 1e9 / nanoseconds << "}"
+                 << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n";
+        file << "}\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string jsonPath = "dungeon_bench.json";
+    std::string filter;
+    double minTime = 0.5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (arg == "--min-time" && i + 1 < argc)
+        {
+            minTime = std::stod(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--json <file>] [--filter <text>] [--min-time <seconds>]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Correctness first: a fast field that is wrong is no use
+    long long repairTiles = checkFlowFieldRepair();
+    int restoredGames = checkSnapshotRestore();
+    if (repairTiles < 0 || restoredGames < 0)
+    {
+        return 1;
+    }
+
+    NullSink sink;
+    GameOutput out(sink);
+    std::vector<BenchResult> results;
+    auto run = [&](const std::string &name, auto body)
+    {
+        if (name.find(filter) != std::string::npos)
+        {
+            results.push_back(measure(name, minTime, body));
+        }
+    };
+
+    run("entity.calculateDamage", [](long long batch)
+        {
+            Entity attacker("Goblin", 30, 9, 3);
+            RandomStream rng(1);
+            long long total = 0;
+            for (long long i = 0; i < batch; ++i)
+            {
+                total += attacker.calculateDamage(rng);
+            }
+            return double(total); });
+
+    run("entity.takeDamage", [&](long long batch)
+        {
+            Entity defender("Slime", 2000000000, 5, 4);
+            long long total = 0;
+            for (long long i = 0; i < batch; ++i)
+            {
+                total += defender.takeDamage(8 + (i & 3), out);
+            }
+            return double(total); });
+
+    // One op = regenerating the enemies of every dungeon level in turn
+    run("game.createEnemies.allLevels", [](long long batch)
+        {
+            GreedyPolicy policy;
+            NullSink quiet;
+            Game game(&policy, 1, &quiet);
+            double total = 0.0;
+            for (long long i = 0; i < batch; ++i)
+            {
+                for (int level = 1; level <= game.getMaxDungeonLevel(); ++level)
+                {
+                    DungeonBenchAccess::createEnemies(game, level);
+                }
+                total += game.getCurrentEnemy() ? 1.0 : 0.0;
+            }
+            return total; });
+
+    // One op = generating one 32x32 chunk of a level from scratch
+    run("dungeon.generateChunk", [](long long batch)
+        {
+            DungeonChunk chunk;
+            double floor = 0.0;
+            for (long long i = 0; i < batch; ++i)
+            {
+                DungeonMap::generateChunk(7, 3, 0, {static_cast<std::int32_t>(i & 63), static_cast<std::int32_t>(i >> 6)}, chunk);
+                floor += chunk.layout.count;
+            }
+            return floor; });
+
+    // One op = a flow field over a 2x2-chunk level toward 8 encounters, then removing one of them
+    run("pathfinding.flowField.buildRemove", [](long long batch)
+        {
+            DungeonMap map;
+            map.reset(7, 3, 2);
+            FlowField field;
+            double steps = 0.0;
+            for (long long i = 0; i < batch; ++i)
+            {
+                field.reset(map, {0, 0}, 2, 2);
+                for (std::uint16_t goal = 0; goal < 8; ++goal)
+                {
+                    field.addGoal(goal, map.encounterPosition(goal));
+                }
+                field.build();
+                field.removeGoal(static_cast<std::uint16_t>(i & 7));
+                steps += field.distanceAt(map.startPosition());
+            }
+            return steps; });
+
+    // One op = an A* query from the start room to an encounter, with the node pool warm
+    run("pathfinding.findPath", [](long long batch)
+        {
+            DungeonMap map;
+            map.reset(7, 3, 2);
+            PathFinder finder;
+            std::vector<TilePos> path;
+            double steps = 0.0;
+            for (long long i = 0; i < batch; ++i)
+            {
+                finder.findPath(map, map.startPosition(), map.encounterPosition(static_cast<std::size_t>(i & 7)), path);
+                steps += double(path.size());
+            }
+            return steps; });
+
+    // One op = one combat event written to a game's ring, with no file attached
+    run("events.emit", [](long long batch)
+        {
+            auto events = std::make_unique<CombatEventLog>();
+            for (long long i = 0; i < batch; ++i)
+            {
+                events->emit(CombatEventType::DAMAGE, EventActor::ENEMY, 0, static_cast<std::int32_t>(i & 15),
+                             static_cast<std::int32_t>(i), static_cast<int>(i >> 4), 3, 2);
+            }
+            return double(events->recent(0).value + events->getWritten()); });
+
+    // One op = one addItem plus one useItem on an inventory holding tens of thousands of items
+    run("player.addUseItem.largeInventory", [&](long long batch)
+        {
+            Player player("Hoarder");
+            std::array<std::uint16_t, MAX_ITEM_TYPES> counts{};
+            for (std::size_t id = 0; id < ItemRegistry::size(); ++id)
+            {
+                counts[id] = 50000;
+            }
+            player.restoreInventory(counts);
+            long long used = 0;
+            for (long long i = 0; i < batch; ++i)
+            {
+                player.addItem(HEALTH_POTION, out);
+                used += player.useItem(HEALTH_POTION, out) ? 1 : 0;
+            }
+            return double(used + player.getItemCount(HEALTH_POTION)); });
+
+    // One op = branching a mid-game state and rolling back to it (GameImage.h)
+    run("game.captureRestoreImage", [](long long batch)
+        {
+            GreedyPolicy policy;
+            NullSink quiet;
+            Game game(&policy, 1, &quiet);
+            for (int i = 0; i < 40 && game.step(); ++i)
+            {
+            }
+            GameImage image;
+            double turns = 0.0;
+            for (long long i = 0; i < batch; ++i)
+            {
+                game.captureImage(image);
+                game.restoreImage(image);
+                turns += image.turnCount;
+            }
+            return turns; });
+
+    // One op = a single-threaded advisor search of 1000 rollouts against a level 3 Skeleton
+    run("advisor.advise.1000rollouts", [&](long long batch)
+        {
+            AdvisorConfig config;
+            config.budget = std::chrono::microseconds(0);
+            config.maxRollouts = 1000;
+            config.threads = 1;
+            CombatAdvisor advisor(config);
+            Player player("Adventurer");
+            player.addItem(HEALTH_POTION, out);
+            Enemy enemy(EnemyRegistry::find("Skeleton"), 3);
+            double rollouts = 0.0;
+            for (long long i = 0; i < batch; ++i)
+            {
+                rollouts += double(advisor.advise(player, enemy).rollouts);
+            }
+            return rollouts; });
+
+    // One op = a whole headless game on a seed the bot is known to win
+    std::uint64_t winningSeed = findWinningSeed();
+    run("game.fullRun.mainMenuToVictory", [winningSeed](long long batch)
+        {
+            double turns = 0.0;
+            for (long long i = 0; i < batch; ++i)
+            {
+                GreedyPolicy policy;
+                NullSink quiet;
+                Game game(&policy, winningSeed, &quiet);
+                while (game.step())
+                {
+                }
+                if (game.getState() != GameState::VICTORY)
+                {
+                    std::cerr << "seed " << winningSeed << " no longer ends in victory\n";
+                    std::exit(1);
+                }
+                turns += game.getTurnCount();
+            }
+            return turns; });
+
+    std::cout << "🏁 DUNGEON BENCH 🏁\n";
+    std::cout << "  flow field repair matches a rebuild on " << repairTiles << " tiles\n";
+    std::cout << "  " << restoredGames << " games restored from snapshots finish as the originals\n";
+    for (const BenchResult &result : results)
+    {
+        double nanoseconds = result.seconds * 1e9 / result.iterations;
+        std::cout << "  " << result.name << ": " << nanoseconds << " ns/op (" << result.iterations << " ops)\n";
+    }
+
+    std::ofstream file(jsonPath);
+    if (!file)
+    {
+        std::cerr << "Could not write " << jsonPath << std::endl;
+        return 1;
+    }
+    writeJson(file, results, minTime);
+    std::cout << "  results written to " << jsonPath << std::endl;
+    return 0;
+}
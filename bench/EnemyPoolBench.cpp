@@ -0,0 +1,90 @@
+#include "DecisionPolicy.h"
+#include "Game.h"
+#include "Output.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+// Counts heap allocations made while the game moves to a new dungeon level.
+// Enemies live in a RecycledSlab sized for the deepest level, so once a game
+// is set up, generating a level should not allocate at all.
+// Usage: enemy_pool_bench [games] [seed]
+
+namespace
+{
+    std::atomic<long long> allocationCount{0};
+}
+
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char *argv[])
+{
+    int games = argc > 1 ? std::stoi(argv[1]) : 10000;
+    std::uint64_t seed = argc > 2 ? std::stoull(argv[2]) : 7;
+
+    long long levelChanges = 0;
+    long long levelAllocations = 0;
+    long long totalAllocations = 0;
+    std::size_t poolGrowths = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < games; ++i)
+    {
+        GreedyPolicy policy;
+        NullSink sink;
+        long long before = allocationCount.load();
+        Game game(&policy, RandomService::deriveSeed(seed, i), &sink);
+
+        for (;;)
+        {
+            int level = game.getCurrentDungeonLevel();
+            long long stepStart = allocationCount.load();
+            bool running = game.step();
+            if (game.getCurrentDungeonLevel() != level)
+            {
+                levelChanges++;
+                levelAllocations += allocationCount.load() - stepStart;
+            }
+            if (!running)
+            {
+                break;
+            }
+        }
+
+        poolGrowths += game.getEnemyPoolAllocations();
+        totalAllocations += allocationCount.load() - before;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "👹 ENEMY POOL BENCHMARK 👹\n";
+    std::cout << "  " << games << " games in " << seconds << " s\n";
+    std::cout << "  level changes: " << levelChanges << "\n";
+    std::cout << "  heap allocations during level changes: " << levelAllocations << "\n";
+    std::cout << "  enemy pool growths: " << poolGrowths << " (" << double(poolGrowths) / games << " per game)\n";
+    std::cout << "  heap allocations per game overall: " << double(totalAllocations) / games << "\n";
+
+    bool steady = levelAllocations == 0;
+    std::cout << (steady ? "  ✅ level generation is allocation-free" : "  ❌ level generation allocated") << std::endl;
+    return steady ? 0 : 1;
+}
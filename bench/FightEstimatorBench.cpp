@@ -0,0 +1,130 @@
+#include "Entity.h"
+#include "FightEstimator.h"
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Checks FightEstimator against fights played out with the real Entity rules,
+// then measures how many estimates per second it answers with a cold and a
+// warm cache.
+// Usage: fight_estimator_bench [matchups] [playouts]
+
+namespace
+{
+    struct Matchup
+    {
+        CombatantStats player;
+        CombatantStats enemy;
+    };
+
+    std::vector<Matchup> makeMatchups(std::size_t count, std::uint64_t seed)
+    {
+        RandomStream rng(seed);
+        std::vector<Matchup> matchups;
+        matchups.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            CombatantStats player{rng.uniformInt(20, 200), rng.uniformInt(8, 40), rng.uniformInt(3, 20)};
+            CombatantStats enemy{rng.uniformInt(10, 200), rng.uniformInt(4, 30), rng.uniformInt(1, 15)};
+            matchups.push_back({player, enemy});
+        }
+        return matchups;
+    }
+
+    // Plays the fight the way Game::handleCombat does when the player always attacks
+    FightEstimate playOut(const Matchup &matchup, int playouts, RandomStream &rng)
+    {
+        NullSink sink;
+        GameOutput out(sink);
+        double wins = 0.0;
+        double rounds = 0.0;
+        double health = 0.0;
+        for (int i = 0; i < playouts; ++i)
+        {
+            Entity player("Player", matchup.player.health, matchup.player.attack, matchup.player.defense);
+            Entity enemy("Enemy", matchup.enemy.health, matchup.enemy.attack, matchup.enemy.defense);
+            for (;;)
+            {
+                rounds++;
+                enemy.takeDamage(player.calculateDamage(rng), out);
+                if (!enemy.isAlive())
+                {
+                    wins++;
+                    health += player.getHealth();
+                    break;
+                }
+                player.takeDamage(enemy.calculateDamage(rng), out);
+                if (!player.isAlive())
+                {
+                    break;
+                }
+            }
+        }
+        return {wins / playouts, rounds / playouts, health / playouts, wins > 0 ? health / wins : 0.0};
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::size_t count = argc > 1 ? std::stoul(argv[1]) : 2000;
+    int playouts = argc > 2 ? std::stoi(argv[2]) : 20000;
+
+    std::vector<Matchup> matchups = makeMatchups(count, 11);
+
+    std::cout << "🎲 FIGHT ESTIMATOR BENCHMARK 🎲\n";
+
+    // Accuracy: a handful of matchups against many playouts each
+    FightEstimator estimator;
+    RandomStream rng(3);
+    double worstWin = 0.0;
+    double worstRounds = 0.0;
+    std::size_t checked = std::min<std::size_t>(count, 20);
+    for (std::size_t i = 0; i < checked; ++i)
+    {
+        FightEstimate exact = estimator.estimate(matchups[i].player, matchups[i].enemy);
+        FightEstimate played = playOut(matchups[i], playouts, rng);
+        worstWin = std::max(worstWin, std::abs(exact.winProbability - played.winProbability));
+        worstRounds = std::max(worstRounds, std::abs(exact.expectedRounds - played.expectedRounds) /
+                                                std::max(1.0, exact.expectedRounds));
+    }
+    std::cout << "  " << checked << " matchups x " << playouts << " playouts: worst win probability error "
+              << worstWin << ", worst relative rounds error " << worstRounds << "\n";
+
+    // Speed: every matchup once with an empty cache, then again from the cache
+    estimator.clear();
+    double checksum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (const Matchup &matchup : matchups)
+    {
+        checksum += estimator.estimate(matchup.player, matchup.enemy).winProbability;
+    }
+    double coldSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < 100; ++pass)
+    {
+        for (const Matchup &matchup : matchups)
+        {
+            checksum += estimator.estimate(matchup.player, matchup.enemy).winProbability;
+        }
+    }
+    double warmSeconds = secondsSince(start);
+
+    std::cout << "  cold: " << count / coldSeconds << " estimates/s\n";
+    std::cout << "  cached: " << count * 100 / warmSeconds << " estimates/s\n";
+    std::cout << "  (checksum " << checksum << ")\n";
+
+    // Playouts are noisy: 20000 of them put the standard error near 0.0035
+    bool accurate = worstWin < 0.02;
+    std::cout << (accurate ? "  ✅ estimates match the playouts" : "  ❌ estimates disagree with the playouts")
+              << std::endl;
+    return accurate ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#ifndef BALANCE_H
+#define BALANCE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Every tunable number of the game rules in one place. The defaults are the
+// original game; enemy base stats themselves live in the archetype table
+// (EnemyArchetype.h) and are scaled by the percentages here.
+struct BalanceParams
+{
+    // Player progression (Player::levelUp)
+    int levelUpHealth = 20;
+    int levelUpAttack = 5;
+    int levelUpDefense = 2;
+    int experiencePerLevel = 100; // Next level needs this times the new level
+
+    // Enemy scaling, as a percentage of the archetype stats
+    int enemyHealthPercent = 100;
+    int enemyAttackPercent = 100;
+    int enemyDefensePercent = 100;
+    int bossHealthPercent = 100;
+    int bossAttackPercent = 100;
+    int bossDefensePercent = 100;
+
+    // Nick's shop
+    int potionPrice = 20;
+    int attackBoostPrice = 50;
+    int defenseBoostPrice = 50;
+
+    // Combat (Game::handleCombat); chances are out of ten, one d10 roll each
+    int potionDropInTen = 3;
+    int escapeInTen = 7;
+    int defendBonus = 5; // Taken off the enemy's roll while defending
+};
+
+// One entry of the parameter vector: how to reach it and the range a sweep may use
+struct BalanceField
+{
+    std::string_view name; // Spelling in balance files
+    int BalanceParams::*member;
+    int low;
+    int high;
+};
+
+// The rules in force. Like the enemy table, they apply to the whole process
+// and must only be changed while no game is running.
+class Balance
+{
+public:
+    static const BalanceParams &get();
+    static void set(const BalanceParams &params);
+
+    // The parameter vector, in declaration order
+    static const BalanceField *fields();
+    static std::size_t fieldCount();
+    static const BalanceField *findField(std::string_view name); // Null if there is no such field
+
+    // Balance file: "<name> <value>" per line, blank lines and # comments ignored.
+    // Fields not mentioned keep their default. On failure error names the
+    // offending line and params is unchanged.
+    static bool loadFile(const std::string &path, BalanceParams &params, std::string &error);
+    static bool saveFile(const std::string &path, const BalanceParams &params);
+
+    static int scale(int value, int percent) { return value * percent / 100; }
+};
+
+#endif // BALANCE_H
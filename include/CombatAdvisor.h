@@ -0,0 +1,138 @@
+#ifndef COMBAT_ADVISOR_H
+#define COMBAT_ADVISOR_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "DecisionPolicy.h"
+#include "Item.h"
+
+class Enemy;
+class Player;
+class RandomStream;
+class ThreadPool;
+
+// The moves offered by the combat menu (checking the inventory is not a move)
+enum class CombatAction : std::uint8_t
+{
+    ATTACK,
+    DEFEND,
+    USE_ITEM,
+    RUN_AWAY
+};
+
+struct CombatMove
+{
+    CombatAction action;
+    ItemId item; // Which item for USE_ITEM, NO_ITEM otherwise
+};
+
+// Attack, defend, run away, plus one USE_ITEM per item type
+const std::size_t MAX_COMBAT_MOVES = 3 + MAX_ITEM_TYPES;
+
+enum class CombatOutcome : std::uint8_t
+{
+    ONGOING,
+    WON,
+    LOST,
+    ESCAPED
+};
+
+// Light copy of everything a fight depends on: about 60 bytes, copied once
+// per rollout. apply() plays one move by the same rules as Game::handleCombat.
+struct CombatState
+{
+    std::int32_t health;
+    std::int32_t maxHealth;
+    std::int32_t attack;
+    std::int32_t defense;
+    std::int32_t enemyHealth;
+    std::int32_t enemyAttack;
+    std::int32_t enemyDefense;
+    bool enemyIsBoss;
+    std::array<std::uint16_t, MAX_ITEM_TYPES> itemCounts;
+
+    static CombatState from(const Player &player, const Enemy &enemy);
+
+    // Fills moves with every legal move and returns how many there are
+    std::size_t legalMoves(CombatMove *moves) const;
+    CombatOutcome apply(const CombatMove &move, RandomStream &rng);
+};
+
+struct AdvisorConfig
+{
+    // Stop searching after this long; zero means no time limit
+    std::chrono::microseconds budget{5000};
+    // Stop after this many rollouts in total; zero means no limit. With no
+    // time limit the search is deterministic for a given seed.
+    std::uint64_t maxRollouts = 0;
+    unsigned threads = 0; // Zero means one per hardware core; one searches on the caller's thread
+    std::uint64_t seed = 1;
+};
+
+struct CombatMoveStats
+{
+    CombatMove move;
+    std::uint64_t visits;
+    double meanValue; // 0 for a loss, up to 1 for a win at full health
+};
+
+struct CombatAdvice
+{
+    CombatMove best;
+    std::array<CombatMoveStats, MAX_COMBAT_MOVES> moves;
+    std::size_t moveCount;
+    std::uint64_t rollouts;
+    double elapsedSeconds;
+};
+
+// Monte Carlo tree search over the combat menu. Each thread grows its own
+// tree from the same root with its own random stream (root parallelism), and
+// the root statistics are summed at the end; the most visited move wins.
+// Chance is not part of the tree: every iteration replays the chosen moves
+// from the root with fresh dice, so a node stands for a sequence of moves.
+//
+// Leaves are valued by playing the fight out with a simple attack-and-heal
+// rollout policy. Winning is worth 0.5 to 1 depending on the health and
+// healing items left afterwards, escaping a quarter of that, and losing 0.
+//
+// advise() must not be called from two threads at once.
+class CombatAdvisor
+{
+private:
+    AdvisorConfig config;
+    std::unique_ptr<ThreadPool> pool;
+    std::uint64_t searches; // Calls so far; keeps each search's streams distinct
+
+public:
+    explicit CombatAdvisor(const AdvisorConfig &config = AdvisorConfig());
+    ~CombatAdvisor();
+    CombatAdvisor(const CombatAdvisor &) = delete;
+    CombatAdvisor &operator=(const CombatAdvisor &) = delete;
+
+    CombatAdvice advise(const CombatState &state);
+    CombatAdvice advise(const Player &player, const Enemy &enemy);
+
+    const AdvisorConfig &getConfig() const;
+};
+
+// Bot that lets the advisor pick every combat move (including which item to
+// use) and plays like GreedyPolicy everywhere else
+class MctsPolicy : public DecisionPolicy
+{
+private:
+    CombatAdvisor advisor;
+    GreedyPolicy fallback;
+    ItemId pendingItem; // Chosen with "Use item", answered at the item prompt
+
+public:
+    explicit MctsPolicy(const AdvisorConfig &config = AdvisorConfig());
+
+    int choose(const Game &game, ChoicePrompt prompt) override;
+};
+
+const char *combatMoveName(const CombatMove &move);
+
+#endif // COMBAT_ADVISOR_H
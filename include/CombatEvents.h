@@ -0,0 +1,149 @@
+#ifndef COMBAT_EVENTS_H
+#define COMBAT_EVENTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Typed record of what happens in a game (damage, healing, rewards, drops,
+// level-ups and state changes), for analytics that would otherwise have to
+// parse the game text. Each game writes fixed-size records into its own ring
+// buffer; with an event file attached, every full ring is appended to the file
+// as one block, so the disk sees large sequential writes and emitting an event
+// is a 32-byte store.
+//
+// Event file, version 1 (native little-endian): a sequence of blocks, each a
+// CombatEventBlockHeader followed by count CombatEvent records. Games append
+// whole blocks, so files from several runs or processes can be concatenated.
+
+enum class CombatEventType : std::uint8_t
+{
+    DAMAGE,           // actor took amount damage; value = its health afterwards
+    HEAL,             // actor regained amount health; value = its health afterwards
+    EXPERIENCE,       // amount XP gained; value = XP afterwards
+    BDP,              // amount BDP earned (negative when spent); value = BDP afterwards
+    ITEM_DROP,        // subject = item ID dropped by the enemy; value = how many are held afterwards
+    LEVEL_UP,         // value = the player's new level
+    STATE_TRANSITION, // subject = previous GameState; value = new GameState
+    COUNT
+};
+
+enum class EventActor : std::uint8_t
+{
+    PLAYER,
+    ENEMY
+};
+
+const std::uint16_t NO_EVENT_ENEMY = 0xFFFF;
+
+struct CombatEvent
+{
+    std::uint64_t session;  // Seed of the game that emitted it
+    std::uint32_t sequence; // Position in that game's stream, from 0
+    std::uint32_t turn;     // Choices made so far
+    CombatEventType type;
+    EventActor actor;
+    std::uint16_t subject; // See CombatEventType
+    std::int32_t amount;
+    std::int32_t value;
+    std::uint16_t dungeonLevel;
+    std::uint16_t enemy; // Archetype of the enemy being fought, or NO_EVENT_ENEMY
+};
+
+const std::uint32_t COMBAT_EVENT_MAGIC = 0x56454344; // "DCEV"
+const std::uint16_t COMBAT_EVENT_VERSION = 1;
+
+struct CombatEventBlockHeader
+{
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t recordSize;
+    std::uint32_t count;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(CombatEvent) == 32 && sizeof(CombatEventBlockHeader) == 16,
+              "event records are part of the file format");
+
+std::string_view combatEventTypeName(CombatEventType type);
+
+class AsyncFileSink;
+
+// Appends event blocks to a file from any number of games and threads. The
+// blocks go through the same background writer as --log, so a game that
+// spills never waits on the disk.
+class CombatEventFile
+{
+private:
+    std::unique_ptr<AsyncFileSink> sink;
+    std::mutex mutex; // The writer queue takes one producer at a time
+
+public:
+    explicit CombatEventFile(const std::string &path);
+    ~CombatEventFile();
+
+    bool isOpen() const;
+    void append(const CombatEvent *events, std::size_t count);
+};
+
+// One game's events. Without a file the ring keeps the most recent CAPACITY
+// events and overwrites older ones; with a file nothing is lost, since a full
+// ring is spilled before it wraps.
+class CombatEventLog
+{
+public:
+    static const std::size_t CAPACITY = 512; // Power of two: 16 KB per game
+
+private:
+    CombatEvent ring[CAPACITY];
+    std::uint64_t session = 0;
+    std::uint32_t written = 0; // Events emitted so far
+    std::uint32_t spilled = 0; // Events already handed to the file
+    CombatEventFile *file = nullptr;
+
+    void spill();
+
+public:
+    void setSession(std::uint64_t seed) { session = seed; }
+    void setFile(CombatEventFile *eventFile); // Spills what is pending to the old file first
+    void flush();                             // Hand pending events to the file, if there is one
+
+    void emit(CombatEventType type, EventActor actor, std::uint16_t subject, std::int32_t amount,
+              std::int32_t value, int turn, int dungeonLevel, std::uint16_t enemy)
+    {
+        ring[written & (CAPACITY - 1)] = {session, written, static_cast<std::uint32_t>(turn), type, actor,
+                                           subject, amount, value, static_cast<std::uint16_t>(dungeonLevel), enemy};
+        if (++written - spilled == CAPACITY && file)
+        {
+            spill();
+        }
+    }
+
+    std::uint32_t getWritten() const { return written; }
+    std::size_t recentCount() const { return written < CAPACITY ? written : CAPACITY; }
+    const CombatEvent &recent(std::size_t back) const { return ring[(written - 1 - back) & (CAPACITY - 1)]; } // 0 is the newest
+};
+
+// Walks the blocks of an event file held in memory, such as a MappedFile
+class CombatEventReader
+{
+private:
+    const char *data;
+    std::size_t size;
+    std::size_t offset = 0;
+    bool damaged = false;
+
+public:
+    CombatEventReader(const void *data, std::size_t size);
+
+    // The records of the next block; empty at the end of the data or at a block that fails its checks
+    std::span<const CombatEvent> nextBlock();
+    bool isDamaged() const { return damaged; } // Stopped early at a bad or truncated block
+    std::size_t getOffset() const { return offset; }
+};
+
+#endif // COMBAT_EVENTS_H
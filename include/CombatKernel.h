@@ -0,0 +1,49 @@
+#ifndef COMBAT_KERNEL_H
+#define COMBAT_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Random.h"
+
+// Combatant stats stored structure-of-arrays, one contiguous array per field
+class CombatantArrays
+{
+public:
+    std::vector<std::int32_t> health;
+    std::vector<std::int32_t> maxHealth;
+    std::vector<std::int32_t> attack;
+    std::vector<std::int32_t> defense;
+
+    std::size_t size() const;
+    void reserve(std::size_t count);
+    void clear();
+    std::size_t add(int health, int attack, int defense);
+};
+
+// Instruction set used to resolve a batch
+enum class CombatKernelIsa
+{
+    SCALAR,
+    SSE41,
+    AVX2
+};
+
+// Best instruction set supported by this CPU
+CombatKernelIsa detectCombatKernelIsa();
+bool isCombatKernelIsaSupported(CombatKernelIsa isa);
+const char *combatKernelIsaName(CombatKernelIsa isa);
+
+// Fill rolls[0..count) with the -2..+2 modifiers Entity::calculateDamage() draws
+void rollDamageModifiers(RandomStream &rng, std::int32_t *rolls, std::size_t count);
+
+// Attacker i hits defender i for every lane, with the same rules as
+// Entity::calculateDamage() followed by Entity::takeDamage():
+//   damage = max(1, attack + roll); dealt = max(1, damage - defense); health = max(0, health - dealt)
+// damageDealt may be null; otherwise it receives the damage applied per lane.
+void resolveExchanges(const CombatantArrays &attackers, CombatantArrays &defenders,
+                      const std::int32_t *rolls, std::int32_t *damageDealt = nullptr);
+void resolveExchanges(const CombatantArrays &attackers, CombatantArrays &defenders,
+                      const std::int32_t *rolls, std::int32_t *damageDealt, CombatKernelIsa isa);
+
+#endif // COMBAT_KERNEL_H
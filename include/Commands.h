@@ -0,0 +1,41 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Slash commands a player can type at any numeric prompt
+enum class CommandId : std::uint8_t
+{
+    STATUS,
+    INVENTORY,
+    HELP,
+    EXIT,
+    ADVISE,
+    MAP,
+    COUNT
+};
+
+// One spelling of a command. Aliases are extra entries with the same id and
+// no help text; the first spelling of each command carries the help line.
+struct CommandSpec
+{
+    std::string_view name;
+    CommandId id;
+    std::string_view help;
+};
+
+// Every spelling, in /help order
+const CommandSpec *commandSpecs();
+std::size_t commandSpecCount();
+
+// Exact match through a perfect hash built at compile time
+std::optional<CommandId> findCommand(std::string_view line);
+
+// Menu choice typed as plain decimal digits, without exceptions; nothing if the
+// line is empty, has any other character, or does not fit in an int
+std::optional<int> parseChoice(std::string_view line);
+
+#endif // COMMANDS_H
@@ -0,0 +1,42 @@
+#ifndef DECISION_POLICY_H
+#define DECISION_POLICY_H
+
+class Game;
+
+// Which menu the game is asking a choice for
+enum class ChoicePrompt
+{
+    MAIN_MENU,
+    EXPLORING,
+    COMBAT,
+    SHOP,
+    TALKING_TO_NPC,
+    USE_ITEM
+};
+
+// Supplies menu choices in place of a human player (headless mode)
+class DecisionPolicy
+{
+public:
+    virtual ~DecisionPolicy() = default;
+
+    // Return the menu number the player would type at this prompt
+    virtual int choose(const Game &game, ChoicePrompt prompt) = 0;
+};
+
+// Simple bot: keeps its health up, buys potions and boosts, then fights
+class GreedyPolicy : public DecisionPolicy
+{
+public:
+    int choose(const Game &game, ChoicePrompt prompt) override;
+
+private:
+    int chooseExploring(const Game &game) const;
+    int chooseCombat(const Game &game) const;
+    int chooseShop(const Game &game) const;
+    int chooseNPC(const Game &game) const;
+    int chooseItem(const Game &game) const;
+    bool wantsToShop(const Game &game) const;
+};
+
+#endif // DECISION_POLICY_H
@@ -0,0 +1,82 @@
+#ifndef DIALOGUE_H
+#define DIALOGUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Dialogue corpus, version 1: every line an NPC can say, compiled by
+// dialogue_compiler into one read-only file. Layout (native little-endian,
+// 8-byte aligned):
+//
+//   DialogueHeader
+//   DialoguePoolRecord [poolCount]    named runs of consecutive lines
+//   DialogueLineRecord [lineCount]
+//   text               [textBytes]    pool names and lines, not terminated
+//
+// The file is mapped once and shared by every session in the process (and,
+// through the page cache, by every process). Loading checks the header and
+// the pools only; a line record is bounds-checked when it is read, so nothing
+// is parsed or copied up front.
+
+const std::uint32_t DIALOGUE_MAGIC = 0x4c444344; // "DCDL"
+const std::uint16_t DIALOGUE_VERSION = 1;
+
+struct DialogueHeader
+{
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t headerSize;
+    std::uint32_t totalSize;
+    std::uint32_t poolCount;
+    std::uint32_t lineCount;
+    std::uint32_t textBytes;
+};
+
+struct DialoguePoolRecord
+{
+    std::uint32_t nameOffset; // Into the text section
+    std::uint32_t nameLength;
+    std::uint32_t firstLine;
+    std::uint32_t lineCount;
+};
+
+struct DialogueLineRecord
+{
+    std::uint32_t offset; // Into the text section
+    std::uint32_t length;
+};
+
+// Lines first .. first + count - 1 of the active corpus
+struct DialogueRange
+{
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+
+    bool empty() const { return count == 0; }
+};
+
+// The corpus in use: a compiled file mapped read-only, or the built-in
+// corpus, which is content/dialogue.txt embedded by the build and compiled the
+// first time a line is needed.
+// Loading replaces it for the whole process, so it must happen before any
+// game is created.
+class DialogueCorpus
+{
+public:
+    static DialogueRange find(std::string_view pool); // Empty if there is no such pool
+    static std::string_view line(std::uint32_t index); // "..." for an index or record out of range
+    static std::size_t lineCount();
+
+    static bool loadFile(const std::string &path, std::string &error);
+    static void useBuiltIn();
+
+    // Source format for dialogue_compiler: "[pool]" starts a pool and every
+    // other non-blank line is one line of it; lines starting with # are
+    // comments. On failure error names the offending line.
+    static bool compile(std::string_view source, std::vector<char> &corpus, std::string &error);
+};
+
+#endif // DIALOGUE_H
@@ -0,0 +1,133 @@
+#ifndef DUNGEON_H
+#define DUNGEON_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Tile-based dungeon levels, generated in fixed-size chunks on demand.
+//
+// A chunk is a pure function of (seed, level, extent, chunk coordinates): it
+// is never saved, only regenerated, and the same inputs always produce the
+// same bytes. Each chunk carves up to MAX_CHUNK_ROOMS rooms joined by
+// corridors, plus a corridor from its first room to a doorway on every edge
+// it shares with another chunk. A doorway's position is drawn from the edge
+// itself, so both neighbours carve it in the same place without looking at
+// each other and every chunk of a level is reachable from every other.
+
+const int CHUNK_SIZE = 32; // Tiles per side
+const int MAX_CHUNK_ROOMS = 4;
+
+enum class Tile : std::uint8_t
+{
+    WALL,
+    FLOOR,
+    CORRIDOR
+};
+
+// World tile coordinates; chunk (0, 0) covers tiles 0 .. CHUNK_SIZE - 1 on both axes
+struct TilePos
+{
+    std::int32_t x = 0;
+    std::int32_t y = 0;
+
+    bool operator==(const TilePos &) const = default;
+};
+
+struct ChunkCoord
+{
+    std::int32_t x = 0;
+    std::int32_t y = 0;
+
+    bool operator==(const ChunkCoord &) const = default;
+
+    static ChunkCoord of(TilePos tile); // The chunk holding the tile
+};
+
+// A room in chunk-local tiles
+struct DungeonRoom
+{
+    std::int8_t x, y, width, height;
+
+    TilePos center() const { return {x + width / 2, y + height / 2}; }
+};
+
+// The room layout of a chunk, which is all encounter placement needs
+struct ChunkRooms
+{
+    std::array<DungeonRoom, MAX_CHUNK_ROOMS> rooms{};
+    int count = 0;
+};
+
+struct DungeonChunk
+{
+    ChunkCoord coord;
+    ChunkRooms layout;
+    std::array<Tile, CHUNK_SIZE * CHUNK_SIZE> tiles; // Row-major, local coordinates
+
+    Tile at(int localX, int localY) const { return tiles[localY * CHUNK_SIZE + localX]; }
+};
+
+// One dungeon level. Chunks are generated the first time a tile in them is
+// read and kept in a fixed number of slots; when the slots run out the least
+// recently used chunk is dropped and regenerated if it is needed again, so
+// memory stays bounded however far the level extends.
+class DungeonMap
+{
+private:
+    struct Slot
+    {
+        DungeonChunk chunk;
+        std::uint64_t lastUse = 0; // Zero while the slot is empty
+    };
+
+    std::uint64_t seed = 0;
+    int level = 0;
+    int extent = 0;       // Chunks per side, or 0 for an endless level
+    std::vector<Slot> slots;
+    std::size_t capacity;
+    std::size_t lastHit = 0; // Slot of the previous lookup; tiles are read in runs
+    std::uint64_t useClock = 0;
+    std::uint64_t chunksGenerated = 0;
+
+    Slot &slotFor(ChunkCoord coord);
+
+public:
+    static const std::size_t DEFAULT_CACHED_CHUNKS = 64;
+
+    explicit DungeonMap(std::size_t cachedChunks = DEFAULT_CACHED_CHUNKS);
+
+    // Start a new level; cached chunks are forgotten but their slots are kept
+    void reset(std::uint64_t seed, int level, int extent);
+
+    std::uint64_t getSeed() const { return seed; }
+    int getLevel() const { return level; }
+    int getExtent() const { return extent; }
+    bool contains(ChunkCoord coord) const; // Inside the level (always true when endless)
+
+    Tile tileAt(TilePos tile); // WALL outside the level
+    bool isWalkable(TilePos tile) { return tileAt(tile) != Tile::WALL; }
+    // Generated now if it is not cached; the reference lasts until the next lookup
+    const DungeonChunk &chunk(ChunkCoord coord);
+    // Generate the chunks within radius of the one holding tile, so they are
+    // ready before the player walks into them
+    void prefetch(TilePos tile, int radius = 1);
+
+    // Centre of the first room of chunk (0, 0)
+    TilePos startPosition() const;
+    // Where the index-th encounter of the level waits: a floor tile in a room
+    // other than the start room. Computed from room layouts alone, so no
+    // chunk is generated; the same index always gives the same tile.
+    TilePos encounterPosition(std::size_t index) const;
+
+    std::size_t cachedChunks() const;
+    std::size_t getCapacity() const { return capacity; }
+    std::uint64_t getChunksGenerated() const { return chunksGenerated; }
+
+    // The generator itself; DungeonMap only caches its results
+    static ChunkRooms layoutRooms(std::uint64_t seed, int level, int extent, ChunkCoord coord);
+    static void generateChunk(std::uint64_t seed, int level, int extent, ChunkCoord coord, DungeonChunk &chunk);
+};
+
+#endif // DUNGEON_H
@@ -1,30 +1,48 @@
 #ifndef ENEMY_H
 #define ENEMY_H
 
-#include <string>
-#include "Entity.h"
+#include <cstdint>
+#include <string_view>
+#include "EnemyArchetype.h"
+#include "Output.h"
+#include "Random.h"
 
-class Enemy : public Entity
+// One enemy in the dungeon: its type, the level it was spawned for and its
+// remaining health. Everything else is looked up in the archetype, so an
+// enemy is a plain 8-byte record.
+class Enemy
 {
 private:
-    int experienceReward;
-    int bdpReward;
-    bool isBoss;
-    std::string emoji;
+    EnemyArchetypeId archetype;
+    std::uint16_t level;
+    std::int32_t health;
 
 public:
-    Enemy(const std::string &name, int health, int attack, int defense,
-          int experienceReward, int bdpReward, bool isBoss = false,
-          const std::string &emoji = "👹");
+    Enemy() = default; // Uninitialised; only for fixed-size arrays such as GameImage
+    Enemy(EnemyArchetypeId archetype, int level);
+
+    const EnemyArchetype &getArchetype() const;
+    EnemyArchetypeId getArchetypeId() const;
+    int getLevel() const;
 
     // Getters
+    std::string_view getName() const;
+    std::string_view getEmoji() const;
+    int getHealth() const;
+    int getMaxHealth() const;
+    int getAttack() const;
+    int getDefense() const;
     int getExperienceReward() const;
     int getBDPReward() const;
     bool getIsBoss() const;
-    std::string getEmoji() const;
 
-    // Override methods from Entity
-    void displayStats() const override;
+    // Same combat rules as Entity
+    void setHealth(int health);
+    int takeDamage(int damage, GameOutput &out); // Returns the damage actually taken
+    int calculateDamage(RandomStream &rng) const;
+    bool isAlive() const;
+
+    void displayStats(GameOutput &out) const;
 };
 
-#endif // ENEMY_H
\ No newline at end of file
+#endif // ENEMY_H
@@ -0,0 +1,65 @@
+#ifndef ENEMY_ARCHETYPE_H
+#define ENEMY_ARCHETYPE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Small integer handle for an enemy type; enemies store it instead of their
+// own name, emoji and stats. IDs are positions in the active table.
+using EnemyArchetypeId = std::uint8_t;
+
+const std::size_t MAX_ENEMY_ARCHETYPES = 255;
+const EnemyArchetypeId NO_ARCHETYPE = 0xFF;
+
+// A stat that grows linearly with the dungeon level
+struct StatScaling
+{
+    int base;
+    int perLevel;
+
+    constexpr int at(int level) const { return base + perLevel * level; }
+};
+
+// Everything enemies of one type share
+struct EnemyArchetype
+{
+    std::string_view name;
+    std::string_view emoji;
+    StatScaling health;
+    StatScaling attack;
+    StatScaling defense;
+    StatScaling experienceReward;
+    StatScaling bdpReward;
+    bool isBoss; // Bosses only appear on the last level, regular types on every level
+};
+
+// The enemy types in play: the built-in table, or one loaded from a content file.
+// Loading replaces the table for the whole process, so it must happen before any
+// game is created.
+class EnemyRegistry
+{
+public:
+    static std::size_t size();
+    static bool isValid(EnemyArchetypeId id);
+    static const EnemyArchetype &get(EnemyArchetypeId id); // id must be valid
+    static EnemyArchetypeId find(std::string_view name);   // NO_ARCHETYPE if there is no such type
+
+    // IDs of the regular types and of the bosses, in table order
+    static const EnemyArchetypeId *regular();
+    static std::size_t regularCount();
+    static const EnemyArchetypeId *bosses();
+    static std::size_t bossCount();
+
+    // Content file: one type per line, blank lines and # comments ignored.
+    //   <name> <emoji> <health> <attack> <defense> <xp> <bdp> [boss]
+    // Each stat is "base" or "base+perLevel" (e.g. 20+5). Health must be
+    // positive and must not fall with the level, so no enemy spawns dead. At
+    // least one regular type and one boss are required. On failure error
+    // names the offending line and the current table is kept.
+    static bool loadFile(const std::string &path, std::string &error);
+    static void useBuiltIn();
+};
+
+#endif // ENEMY_ARCHETYPE_H
@@ -2,6 +2,9 @@
 #define ENTITY_H
 
 #include <string>
+#include <string_view>
+#include "Random.h"
+#include "Output.h"
 
 class Entity
 {
@@ -17,7 +20,7 @@ public:
     virtual ~Entity() = default;
 
     // Getters
-    std::string getName() const;
+    std::string_view getName() const;
     int getHealth() const;
     int getMaxHealth() const;
     int getAttack() const;
@@ -25,15 +28,15 @@ public:
 
     // Setters and modifiers
     void setHealth(int health);
-    void takeDamage(int damage);
-    void heal(int amount);
+    int takeDamage(int damage, GameOutput &out); // Returns the damage actually taken
+    void heal(int amount, GameOutput &out);
 
     // Combat methods
-    int calculateDamage() const;
+    int calculateDamage(RandomStream &rng) const;
     bool isAlive() const;
 
     // Display methods
-    virtual void displayStats() const;
+    virtual void displayStats(GameOutput &out) const;
 };
 
 #endif // ENTITY_H
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef FIGHT_ESTIMATOR_H
+#define FIGHT_ESTIMATOR_H
+
+#include <array>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class Enemy;
+class Player;
+
+// The numbers that decide a straight fight
+struct CombatantStats
+{
+    int health;
+    int attack;
+    int defense;
+};
+
+// Exact outcome of a fight in which the player attacks every turn
+struct FightEstimate
+{
+    double winProbability;
+    double expectedRounds;          // Player attack plus enemy reply, until someone falls
+    double expectedHealthRemaining; // Player health at the end, counting a loss as 0
+    double expectedHealthIfWon;     // Player health at the end, given that they win
+};
+
+// Computes fight outcomes from the damage distributions instead of playing
+// them out. Each hit deals max(1, max(1, attack + roll) - defense) for a
+// uniform roll in -2..+2 (Entity::calculateDamage then takeDamage). The
+// number of hits each side needs is found by pushing the distribution of
+// damage taken through one hit at a time, and the player wins if they need no
+// more hits than the enemy, since they strike first each round.
+//
+// Results and per-side hit tables are memoized on the stats, so repeated
+// questions are lookups. The memo is dropped whole once it holds
+// MAX_CACHED_FIGHTS results, so a long-lived estimator stays small. Not
+// thread-safe; use one estimator per thread.
+class FightEstimator
+{
+private:
+    static const std::size_t MAX_CACHED_FIGHTS = 4096;
+
+    // Target with some health being hit repeatedly by one attacker.
+    // After j hits: alive[j] = P(still standing), remaining[j] = E[health left; still standing]
+    struct HitTable
+    {
+        std::vector<double> alive;
+        std::vector<double> remaining;
+    };
+
+    template <std::size_t N>
+    struct KeyHash
+    {
+        std::size_t operator()(const std::array<int, N> &key) const;
+    };
+
+    std::unordered_map<std::array<int, 3>, HitTable, KeyHash<3>> hitTables;
+    std::unordered_map<std::array<int, 6>, FightEstimate, KeyHash<6>> estimates;
+
+    const HitTable &hitTable(int health, int attack, int defense);
+
+public:
+    FightEstimate estimate(const CombatantStats &player, const CombatantStats &enemy);
+    FightEstimate estimate(const Player &player, const Enemy &enemy);
+
+    std::size_t cachedFights() const;
+    void clear();
+};
+
+#endif // FIGHT_ESTIMATOR_H
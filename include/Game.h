@@ -4,9 +4,27 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <atomic>
+#include <coroutine>
+#include <optional>
 #include "Player.h"
 #include "Enemy.h"
 #include "NPC.h"
+#include "DecisionPolicy.h"
+#include "Random.h"
+#include "Output.h"
+#include "InputSource.h"
+#include "Task.h"
+#include "Snapshot.h"
+#include "GameImage.h"
+#include "Commands.h"
+#include "Dungeon.h"
+#include "Pathfinding.h"
+#include "RecycledSlab.h"
+#include "FightEstimator.h"
+#include "Metrics.h"
+#include "StatPanel.h"
+#include "CombatEvents.h"
 
 enum class GameState
 {
@@ -19,45 +37,137 @@ enum class GameState
     VICTORY
 };
 
+class SessionRecorder;
+class CombatAdvisor;
+
 class Game
 {
 private:
     GameState currentState;
     Player player;
-    std::vector<std::unique_ptr<Enemy>> enemies;
-    std::vector<std::unique_ptr<NPC>> npcs;
+    RecycledSlab<Enemy> enemies; // Current level's enemies, recycled when the level advances
+    NPCRegistry npcs;
+    NpcId currentNpc; // Who "Talk to" and the shop refer to
     int currentDungeonLevel;
     int maxDungeonLevel;
     int currentEnemyIndex; // Index of the current enemy being fought
+    DungeonMap dungeon;    // Current level's tiles; enemy i waits at dungeon.encounterPosition(i)
+    TilePos playerPosition;
+    FlowField encounterField; // Steps to the nearest live enemy over the chunks around the player
+    bool encounterFieldReady;  // Built on the first walk of a level, patched as enemies fall
+    int turnCount;         // Number of choices made so far
+    RandomService rng;     // Session-owned random streams
+    FightEstimator fightEstimator; // Win odds shown in combat
+    [[no_unique_address]] GameMetrics metrics; // Per-handler counters and timings (Metrics.h)
+    SessionRecorder *recorder;                 // Receives input lines and checkpoints when set
+    std::unique_ptr<CombatAdvisor> advisor;    // Created the first time /advise is used
+    StatPanel playerPanel;                     // Stats panels as last drawn, reused until a value changes
+    StatPanel enemyPanel;
+    CombatEventLog events;                     // Typed record of the run (CombatEvents.h), spilled to a file when set
+
+    // Headless mode: choices come from the policy, no terminal I/O or sleeps
+    DecisionPolicy *policy;
+
+    // All game text goes through out; ownedSink is set when no sink was supplied
+    std::unique_ptr<OutputSink> ownedSink;
+    GameOutput out;
+
+    // Typed lines come from input; ownedInput is the console when none was supplied
+    std::unique_ptr<InputSource> ownedInput;
+    InputSource *input;
+    std::atomic<bool> exitRequested;
 
-    // Static pointer to current player for command access
-    static Player *currentPlayerPtr;
+    // The turn in progress and, while it waits for a line, where to resume it
+    struct InputAwaiter;
+    std::optional<Task<>> turn;
+    std::coroutine_handle<> waitingForInput;
 
     // Private methods
     void initializeGame();
     void createNPCs();
     void createEnemies();
-    void displayMainMenu();
-    void displayGameOver();
-    void displayVictory();
-    void handleCombat();
-    void handleExploring();
-    void handleShop();
-    void handleNPCInteraction();
-    void handleUseItem();
+    // One pass of the state machine; a turn suspends wherever it needs input
+    Task<> playTurn();
+    Task<> displayMainMenu();
+    Task<> displayGameOver();
+    Task<> displayVictory();
+    Task<> handleCombat();
+    Task<> handleExploring();
+    Task<> handleShop();
+    Task<> handleNPCInteraction();
+    Task<> handleUseItem();
+    Task<> pauseGame();
+    Task<> waitForEnter();
+    void showPlayerStats();
+    void showEnemyStats(const Enemy &enemy);
     void levelUp();
     void generateDungeon();
+    void buildEncounterField();
+    int walkToNearestEnemy(std::uint32_t &steps); // Enemy index, or -1 if none is reachable
+    // Records an event against the current turn, level and enemy
+    void emitEvent(CombatEventType type, EventActor actor, int amount, int value, std::uint16_t subject = 0);
+    Task<int> readChoice(ChoicePrompt prompt);
+    Task<> readLine(std::string &line);
+    Task<int> readIntInput();
+
+    // Slash commands, dispatched by CommandId
+    using CommandHandler = Task<> (Game::*)();
+    static const CommandHandler COMMAND_HANDLERS[];
+    Task<> showStatusCommand();
+    Task<> showInventoryCommand();
+    Task<> showHelpCommand();
+    Task<> exitCommand();
+    Task<> adviseCommand();
+    Task<> showMapCommand();
+    void dramaticPause();
+
+    // bench/DungeonBench.cpp times level generation directly
+    friend struct DungeonBenchAccess;
 
 public:
-    Game();
+    // Without a sink, interactive games write to the terminal and headless games discard their text;
+    // without an input source, interactive games read the console
+    explicit Game(DecisionPolicy *policy = nullptr,
+                  std::uint64_t seed = RandomService::entropySeed(),
+                  OutputSink *sink = nullptr,
+                  InputSource *input = nullptr);
+    ~Game();
+    Game(const Game &) = delete;
+    Game &operator=(const Game &) = delete;
     void run();
+    // Run one pass of the state machine, or continue one that was waiting for input;
+    // false once the game has ended
+    bool step();
+    bool isWaitingForInput() const; // The last step stopped at an input prompt with no line queued
     void setState(GameState newState);
     GameState getState() const;
-    void clearScreen();
-    void pauseGame();
+    void requestExit(); // Safe to call from any thread; the game ends at the next step
+    void setRecorder(SessionRecorder *recorder); // Record the session (Replay.h); null stops recording
+    void setEventFile(CombatEventFile *file);    // Spill combat events to file; null keeps only the most recent in memory
+    const CombatEventLog &getEvents() const;
 
-    // Static method to access current player
-    static Player *getCurrentPlayer();
+    // Binary checkpoint of the run (player, enemies, level, state and RNG position).
+    // Taken between steps; a turn that was waiting for input restarts from its menu.
+    void saveSnapshot(std::vector<char> &buffer) const;
+    bool loadSnapshot(const SnapshotView &snapshot); // False (and nothing changed) if the snapshot is invalid
+    // In-memory branch point for search, undo and previews (GameImage.h): a copy of
+    // about 256 bytes. Capturing fails only if the level holds more than
+    // MAX_IMAGE_ENEMIES enemies. Restoring, like loading a snapshot, restarts a turn that
+    // was waiting for input; the player's name is kept. Any game may restore an
+    // image, not just the one that took it.
+    bool captureImage(GameImage &image) const;
+    void restoreImage(const GameImage &image);
+    bool isHeadless() const;
+    int getTurnCount() const;
+    std::uint64_t getSeed() const;
+    int getCurrentDungeonLevel() const;
+    int getMaxDungeonLevel() const;
+    TilePos getPlayerPosition() const;
+    const Player &getPlayer() const;
+    const Enemy *getCurrentEnemy() const;
+    std::size_t getEnemyPoolAllocations() const; // Times the enemy storage grew; stays put once the game is set up
+    const NPC *getShopkeeper() const;
+    void clearScreen();
 };
 
 #endif // GAME_H
\ No newline at end of file
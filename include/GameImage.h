@@ -0,0 +1,49 @@
+#ifndef GAME_IMAGE_H
+#define GAME_IMAGE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "Enemy.h"
+#include "Item.h"
+
+const std::size_t MAX_IMAGE_ENEMIES = 15;
+
+// Everything about a run that changes during play, as one 256-byte block of
+// plain data. Game::captureImage and Game::restoreImage copy it in and
+// out, so branching a game for search, undo or a preview costs a copy of this
+// struct. Unlike a snapshot (Snapshot.h) it is an in-memory format only:
+// enemies are kept by archetype ID, so it is only valid with the content it
+// was taken with. It also leaves out the player's name, which only changes
+// when a new game starts.
+struct GameImage
+{
+    std::int32_t state; // GameState
+    std::int32_t currentDungeonLevel;
+    std::int32_t maxDungeonLevel;
+    std::int32_t currentEnemyIndex;
+    std::int32_t turnCount;
+    std::uint32_t enemyCount;
+    std::int32_t playerX; // Tile the player stands on (Dungeon.h)
+    std::int32_t playerY;
+    std::uint64_t seed;
+    std::uint64_t streamCounters[4]; // combat, loot, spawning, dialogue
+
+    std::int32_t health;
+    std::int32_t maxHealth;
+    std::int32_t attack;
+    std::int32_t defense;
+    std::int32_t level;
+    std::int32_t experience;
+    std::int32_t experienceToNextLevel;
+    std::int32_t bdp;
+    std::array<std::uint16_t, MAX_ITEM_TYPES> itemCounts;
+
+    Enemy enemies[MAX_IMAGE_ENEMIES];
+};
+
+static_assert(std::is_trivially_copyable_v<GameImage> && sizeof(GameImage) == 256,
+              "a game image must stay a small block of plain data");
+
+#endif // GAME_IMAGE_H
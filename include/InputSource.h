@@ -0,0 +1,72 @@
+#ifndef INPUT_SOURCE_H
+#define INPUT_SOURCE_H
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class InputStatus
+{
+    LINE,    // A line was read
+    PENDING, // Nothing typed yet; ask again later
+    CLOSED   // The input has ended
+};
+
+// Where a session's typed lines come from
+class InputSource
+{
+public:
+    virtual ~InputSource() = default;
+
+    // Next line of player input, if there is one
+    virtual InputStatus readLine(std::string &line) = 0;
+
+    // True if readLine would return without waiting
+    virtual bool hasInput() const { return true; }
+};
+
+// Reads from std::cin (the interactive console game); blocks, so never PENDING
+class ConsoleInput : public InputSource
+{
+public:
+    InputStatus readLine(std::string &line) override;
+};
+
+// Replays a fixed list of lines, then reports end of input
+class ScriptedInput : public InputSource
+{
+private:
+    std::vector<std::string> lines;
+    std::size_t next;
+
+public:
+    explicit ScriptedInput(std::vector<std::string> lines);
+
+    InputStatus readLine(std::string &line) override;
+};
+
+// Thread-safe line queue: a connection thread pushes lines, the session reads them
+class QueueInput : public InputSource
+{
+private:
+    mutable std::mutex mutex;
+    std::deque<std::string> lines;
+    bool closed;
+    std::function<void()> listener;
+
+public:
+    QueueInput();
+
+    void push(std::string line);
+    void close();
+
+    // Called (on the pushing thread) after every push or close
+    void setListener(std::function<void()> callback);
+
+    bool hasInput() const override;
+    InputStatus readLine(std::string &line) override;
+};
+
+#endif // INPUT_SOURCE_H
@@ -0,0 +1,49 @@
+#ifndef ITEM_H
+#define ITEM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Small integer handle for an item type; players store counts indexed by it.
+// IDs are positions in the registry table and are saved in snapshots, so new
+// items are only ever appended.
+using ItemId = std::uint8_t;
+
+const std::size_t MAX_ITEM_TYPES = 16;
+const ItemId NO_ITEM = 0xFF;
+
+const ItemId HEALTH_POTION = 0;
+const ItemId ATTACK_BOOST = 1;
+const ItemId DEFENSE_BOOST = 2;
+
+enum class ItemEffect : std::uint8_t
+{
+    NONE,
+    HEAL_PERCENT,  // Restore amount% of max health
+    ATTACK_BONUS,  // Permanently add amount to attack
+    DEFENSE_BONUS  // Permanently add amount to defense
+};
+
+// Immutable metadata shared by every copy of an item
+struct ItemInfo
+{
+    std::string_view name;
+    std::string_view description;
+    std::string_view emoji;
+    bool isConsumable;
+    ItemEffect effect;
+    int amount;
+};
+
+// Global table of every item type in the game
+class ItemRegistry
+{
+public:
+    static std::size_t size();
+    static bool isValid(ItemId id);
+    static const ItemInfo &get(ItemId id); // id must be valid
+    static ItemId find(std::string_view name); // NO_ITEM if there is no such item
+};
+
+#endif // ITEM_H
@@ -0,0 +1,193 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Per-handler counters and latency histograms for Game, exported in the
+// Prometheus text format. Build with -DDUNGEON_METRICS=OFF to compile every
+// hook down to nothing.
+#ifndef DUNGEON_METRICS
+#define DUNGEON_METRICS 1
+#endif
+
+enum class GameState;
+
+// What a measurement is attributed to: one value per GameState (same order),
+// plus handlers that run inside another state's turn
+enum class MetricsHandler : std::uint8_t
+{
+    MAIN_MENU,
+    EXPLORING,
+    COMBAT,
+    SHOP,
+    TALKING_TO_NPC,
+    GAME_OVER,
+    VICTORY,
+    USE_ITEM,
+    COUNT
+};
+
+const std::size_t METRICS_HANDLER_COUNT = static_cast<std::size_t>(MetricsHandler::COUNT);
+const std::size_t METRICS_STATE_COUNT = 7; // GameState values
+const std::size_t METRICS_COMBAT_TURN_BUCKETS = 12;
+
+// Headless turns are timed one in this many (counters still see every turn);
+// games that read real input time every turn
+const std::uint32_t METRICS_TIMING_SAMPLE_EVERY = 256;
+
+constexpr bool metricsCompiledIn() { return DUNGEON_METRICS != 0; }
+
+#if DUNGEON_METRICS
+
+class GameMetrics;
+
+// Times one handler call; records compute time and input wait when it goes out of scope
+class MetricsSpan
+{
+private:
+    GameMetrics *metrics; // Null when this call is not being timed
+    MetricsHandler handler;
+    std::uint64_t start;
+    std::uint64_t waitedAtStart;
+
+public:
+    MetricsSpan(GameMetrics &metrics, MetricsHandler handler);
+    ~MetricsSpan();
+    MetricsSpan(const MetricsSpan &) = delete;
+    MetricsSpan &operator=(const MetricsSpan &) = delete;
+};
+
+// Hooks one game calls as it plays. Counts build up in the game itself and are
+// flushed to a shard owned by the calling thread whenever a turn is timed and
+// when the game ends, so the per-turn cost is a few increments.
+class GameMetrics
+{
+private:
+    friend class MetricsSpan;
+
+    // Counts since the last flush
+    std::uint32_t turns[METRICS_HANDLER_COUNT];
+    std::uint32_t transitions[METRICS_STATE_COUNT][METRICS_STATE_COUNT];
+    std::uint32_t combatTurnBuckets[METRICS_COMBAT_TURN_BUCKETS + 1];
+    std::uint32_t combatTurnSum;
+
+    bool timeEveryTurn;
+    bool timing;              // The current turn is being timed
+    std::uint32_t untilSample; // Turns left before the next timed one (always 1 when timing every turn)
+    int combatTurns;          // Turns in the combat in progress
+    MetricsHandler turnHandler;
+    std::uint64_t waited;     // Input wait so far, in ns
+    std::uint64_t waitStart;
+    std::uint64_t turnStart;
+    std::uint64_t turnWaitedAtStart;
+
+    void startTiming(GameState state);
+    void finishTiming();
+    void finishCombat();
+    void flush();
+
+public:
+    explicit GameMetrics(bool timeEveryTurn);
+    ~GameMetrics();
+    GameMetrics(const GameMetrics &) = delete;
+    GameMetrics &operator=(const GameMetrics &) = delete;
+
+    void beginTurn(GameState state)
+    {
+        turns[static_cast<std::size_t>(state)]++;
+        if (static_cast<MetricsHandler>(state) == MetricsHandler::COMBAT)
+        {
+            combatTurns++;
+        }
+        if (--untilSample == 0)
+        {
+            startTiming(state);
+        }
+    }
+
+    void endTurn()
+    {
+        if (timing)
+        {
+            finishTiming();
+        }
+    }
+
+    void beginInputWait();
+    void endInputWait();
+
+    void transition(GameState from, GameState to)
+    {
+        if (from != to)
+        {
+            transitions[static_cast<std::size_t>(from)][static_cast<std::size_t>(to)]++;
+            if (static_cast<MetricsHandler>(from) == MetricsHandler::COMBAT)
+            {
+                finishCombat();
+            }
+        }
+    }
+};
+
+#else
+
+class GameMetrics;
+
+class MetricsSpan
+{
+public:
+    MetricsSpan(GameMetrics &, MetricsHandler) {}
+};
+
+class GameMetrics
+{
+public:
+    explicit GameMetrics(bool) {}
+
+    void beginTurn(GameState) {}
+    void endTurn() {}
+    void beginInputWait() {}
+    void endInputWait() {}
+    void transition(GameState, GameState) {}
+};
+
+#endif
+
+// Everything recorded so far by every thread, in the Prometheus text format.
+// A non-negative transitionsPerSecond is exported as a gauge alongside.
+std::string renderMetrics(double transitionsPerSecond = -1.0);
+
+// State transitions recorded so far, summed over every thread
+std::uint64_t totalStateTransitions();
+
+// Rewrites a Prometheus text file every interval (through a temporary file, so
+// a scraper never reads half of it) and once more when destroyed
+class MetricsExporter
+{
+private:
+    std::string path;
+    std::chrono::milliseconds interval;
+    std::mutex mutex;
+    std::condition_variable stopRequested;
+    bool stopping;
+    std::uint64_t lastTransitions;
+    std::chrono::steady_clock::time_point lastWrite;
+    std::thread writer;
+
+    void writeOnce();
+    void loop();
+
+public:
+    MetricsExporter(const std::string &path, std::chrono::milliseconds interval);
+    ~MetricsExporter();
+    MetricsExporter(const MetricsExporter &) = delete;
+    MetricsExporter &operator=(const MetricsExporter &) = delete;
+};
+
+#endif // METRICS_H
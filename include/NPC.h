@@ -1,37 +1,101 @@
 #ifndef NPC_H
 #define NPC_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
+#include "Dialogue.h"
+#include "Item.h"
+#include "Random.h"
+#include "Output.h"
+
+// Small integer handle for an NPC: its position in the game's NPCRegistry
+using NpcId = std::uint16_t;
+const NpcId NO_NPC = 0xFFFF;
+
+enum class NPCRole : std::uint8_t
+{
+    VILLAGER,
+    SHOPKEEPER,
+    COUNT
+};
+
+// One line of a shop menu
+struct ShopEntry
+{
+    ItemId item;
+    std::int32_t price; // BDP
+};
+
+// A shop's stock as a flat array in menu order; menu choice n is entry n - 1
+class ShopCatalog
+{
+private:
+    std::vector<ShopEntry> entries;
+
+public:
+    // Lists an item, or changes its price if it is already listed
+    void add(ItemId item, int price);
+
+    std::size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    const ShopEntry &operator[](std::size_t index) const { return entries[index]; }
+    const ShopEntry *begin() const { return entries.data(); }
+    const ShopEntry *end() const { return entries.data() + entries.size(); }
+};
 
 class NPC
 {
 private:
     std::string name;
     std::string emoji;
-    std::vector<std::string> dialogues;
-    std::map<std::string, int> shopItems; // item name -> price in BDP
-    bool isShopkeeper;
+    DialogueRange dialogue; // This NPC's lines in the shared corpus
+    ShopCatalog shop;
+    NPCRole role;
 
 public:
-    NPC(const std::string &name, const std::string &emoji, bool isShopkeeper = false);
+    NPC(const std::string &name, const std::string &emoji, NPCRole role = NPCRole::VILLAGER);
 
     // Getters
-    std::string getName() const;
-    std::string getEmoji() const;
+    std::string_view getName() const;
+    std::string_view getEmoji() const;
+    NPCRole getRole() const;
     bool getIsShopkeeper() const;
 
     // Dialogue methods
-    void addDialogue(const std::string &dialogue);
-    std::string getRandomDialogue() const;
+    void setDialogue(DialogueRange lines);
+    std::string_view getRandomDialogue(RandomStream &rng) const; // Points into the corpus
 
     // Shop methods
-    void addShopItem(const std::string &itemName, int price);
-    const std::map<std::string, int> &getShopItems() const;
+    void addShopItem(ItemId item, int price);
+    const ShopCatalog &getShop() const;
 
     // Display methods
-    void displayInfo() const;
+    void displayInfo(RandomStream &rng, GameOutput &out) const;
+};
+
+// The NPCs of one game, stored contiguously and indexed by ID and by role
+class NPCRegistry
+{
+private:
+    std::vector<NPC> npcs;
+    std::array<std::vector<NpcId>, static_cast<std::size_t>(NPCRole::COUNT)> byRole;
+
+public:
+    NpcId add(NPC npc); // NO_NPC once the registry is full
+
+    std::size_t size() const { return npcs.size(); }
+    bool isValid(NpcId id) const { return id < npcs.size(); }
+    const NPC &get(NpcId id) const { return npcs[id]; } // id must be valid
+
+    // IDs of every NPC with the role, in the order they were added
+    const std::vector<NpcId> &withRole(NPCRole role) const;
+    NpcId first(NPCRole role) const; // NO_NPC if nobody has the role
+
+    void clear();
 };
 
-#endif // NPC_H
\ No newline at end of file
+#endif // NPC_H
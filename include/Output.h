@@ -0,0 +1,144 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <charconv>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Destination for game text. The game hands over one complete frame at a time
+// (everything printed since the last time it waited for input).
+class OutputSink
+{
+public:
+    virtual ~OutputSink() = default;
+
+    virtual void writeFrame(std::string_view frame) = 0;
+
+    // Start a new screen (default: emit the ANSI clear sequence)
+    virtual void clearScreen();
+
+    // A line the player typed, which the terminal has already echoed
+    virtual void noteInput(std::string_view) {}
+
+    // Block until every frame handed over so far has reached its destination
+    virtual void drain() {}
+
+    // True if text is thrown away, so callers can skip formatting it
+    virtual bool discardsOutput() const { return false; }
+};
+
+// Drops everything (headless runs)
+class NullSink : public OutputSink
+{
+public:
+    void writeFrame(std::string_view frame) override;
+    void clearScreen() override;
+    bool discardsOutput() const override;
+};
+
+class AsyncWriter;
+
+// Buffered terminal output: each frame goes out in a single write() issued by a
+// background writer thread, so the game thread never blocks on the terminal
+class TerminalSink : public OutputSink
+{
+private:
+    std::unique_ptr<AsyncWriter> writer;
+
+public:
+    TerminalSink();
+    ~TerminalSink() override;
+
+    void writeFrame(std::string_view frame) override;
+    void drain() override;
+};
+
+// Appends frames to a file through a lock-free SPSC queue and a background writer thread
+class AsyncFileSink : public OutputSink
+{
+private:
+    std::unique_ptr<AsyncWriter> writer;
+
+public:
+    explicit AsyncFileSink(const std::string &path);
+    ~AsyncFileSink() override;
+
+    bool isOpen() const;
+    void writeFrame(std::string_view frame) override;
+    void drain() override;
+};
+
+// Formats game text into the current frame and passes finished frames to a sink.
+// When the sink discards output nothing is formatted at all.
+class GameOutput
+{
+private:
+    OutputSink *sink;
+    std::string frame;
+    bool enabled;
+
+    template <typename T>
+    GameOutput &appendInteger(T value)
+    {
+        if (enabled)
+        {
+            char digits[24];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            frame.append(digits, result.ptr);
+        }
+        return *this;
+    }
+
+public:
+    explicit GameOutput(OutputSink &sink);
+
+    OutputSink &getSink() const;
+    bool isEnabled() const { return enabled; }
+
+    // Position in the current frame, and the text written since then (see StatPanel.h)
+    std::size_t framePosition() const { return frame.size(); }
+    std::string_view textSince(std::size_t position) const { return std::string_view(frame).substr(position); }
+
+    GameOutput &operator<<(std::string_view text)
+    {
+        if (enabled)
+        {
+            frame.append(text);
+        }
+        return *this;
+    }
+
+    GameOutput &operator<<(const char *text) { return *this << std::string_view(text); }
+    GameOutput &operator<<(const std::string &text) { return *this << std::string_view(text); }
+
+    GameOutput &operator<<(char c)
+    {
+        if (enabled)
+        {
+            frame.push_back(c);
+        }
+        return *this;
+    }
+
+    GameOutput &operator<<(int value) { return appendInteger(value); }
+    GameOutput &operator<<(long value) { return appendInteger(value); }
+    GameOutput &operator<<(long long value) { return appendInteger(value); }
+    GameOutput &operator<<(unsigned value) { return appendInteger(value); }
+    GameOutput &operator<<(unsigned long value) { return appendInteger(value); }
+    GameOutput &operator<<(unsigned long long value) { return appendInteger(value); }
+
+    // Hand the current frame to the sink (called whenever the game waits for input)
+    void endFrame();
+
+    // End the frame and start a fresh screen
+    void clearScreen();
+
+    // Tell the sink about a line of player input echoed by the terminal
+    void echoInput(std::string_view line);
+
+    // End the frame and wait until the sink has written everything
+    void drain();
+};
+
+#endif // OUTPUT_H
@@ -0,0 +1,124 @@
+#ifndef PATHFINDING_H
+#define PATHFINDING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Dungeon.h"
+
+// Movement on a DungeonMap is one tile north, south, east or west per step,
+// onto any tile that is not a wall.
+
+// A* between two tiles, for point-to-point queries (the game itself walks
+// with FlowField). A query searches a window of whole chunks: those spanning
+// both ends plus a margin of one chunk, inside the level. Its walls are
+// copied into a padded grid like FlowField's, and every grid cell is its own
+// node. Nodes carry the number of the query that last touched them, so
+// nothing is cleared between queries, and once the grid has grown to fit the
+// windows a session asks for, a query allocates nothing.
+class PathFinder
+{
+private:
+    struct Node
+    {
+        std::uint32_t cost;   // Steps from the start
+        std::uint32_t parent; // Cell
+        std::uint32_t seen;   // Query that set cost and parent
+        std::uint32_t closed; // Query that expanded it
+    };
+
+    struct OpenEntry
+    {
+        std::uint32_t estimate; // cost + Manhattan distance to the goal
+        std::uint32_t cell;
+
+        bool operator>(const OpenEntry &other) const
+        {
+            return estimate != other.estimate ? estimate > other.estimate : cell > other.cell;
+        }
+    };
+
+    TilePos origin;
+    std::int32_t stride = 0; // Cells per row, window plus a wall on each side
+    std::vector<std::uint8_t> walkable;
+    std::vector<Node> nodes;     // Indexed by cell
+    std::vector<OpenEntry> open; // Min-heap; stale entries are skipped when popped
+    std::uint32_t query = 0;
+    std::size_t maxExpanded;
+    std::size_t lastExpanded = 0;
+
+    std::uint32_t cellOf(TilePos tile) const
+    {
+        return static_cast<std::uint32_t>((tile.y - origin.y + 1) * stride + tile.x - origin.x + 1);
+    }
+    TilePos tileOf(std::uint32_t cell) const
+    {
+        return {origin.x + static_cast<std::int32_t>(cell % stride) - 1, origin.y + static_cast<std::int32_t>(cell / stride) - 1};
+    }
+
+public:
+    explicit PathFinder(std::size_t maxExpanded = 1 << 18);
+
+    // Fills path with the tiles after start up to and including goal. False,
+    // with path empty, if either end is a wall, the window would hold more
+    // than 1024 chunks, or the goal was not reached within the window and
+    // maxExpanded nodes.
+    bool findPath(DungeonMap &map, TilePos start, TilePos goal, std::vector<TilePos> &path);
+    std::size_t getLastExpanded() const { return lastExpanded; }
+};
+
+// Distance from every tile of a window to the nearest of a set of goals
+// (multi-source Dijkstra), so any number of walkers can head for the nearest
+// goal by stepping downhill without searching. Removing a goal only
+// recomputes the tiles that were nearest to it. A window is a rectangle of
+// whole chunks, read from the map once when the field is reset.
+class FlowField
+{
+public:
+    static constexpr std::uint32_t UNREACHABLE = 0xFFFFFFFF;
+    static constexpr std::uint16_t NO_GOAL = 0xFFFF;
+
+private:
+    TilePos origin;
+    int width = 0;
+    int height = 0;
+    std::int32_t stride = 0; // Cells per row: the window plus a wall on each side, so steps need no bounds checks
+    std::vector<std::uint8_t> walkable;
+    std::vector<std::uint32_t> distance;
+    std::vector<std::uint16_t> owner; // Goal each tile is nearest to
+    std::vector<TilePos> goals;       // Indexed by goal ID
+    std::vector<std::uint8_t> live;
+
+    // Scratch space kept between updates
+    struct QueueEntry
+    {
+        std::uint32_t distance;
+        std::uint32_t cell;
+    };
+    std::vector<QueueEntry> queue; // Cells that start a sweep, nearest first
+    std::vector<std::uint32_t> region;
+
+    std::uint32_t cellOf(int x, int y) const { return static_cast<std::uint32_t>((y + 1) * stride + x + 1); }
+    bool indexOf(TilePos tile, std::uint32_t &cell) const;
+    void seedLiveGoals(); // Queue every live goal whose tile no goal owns yet
+    void sweep(std::size_t next);
+
+public:
+    // Load the walls of the window and drop every goal
+    void reset(DungeonMap &map, ChunkCoord first, int chunksWide, int chunksHigh);
+    // Goals outside the window or on a wall are remembered but never reached
+    void addGoal(std::uint16_t id, TilePos tile);
+    void build(); // Distances to every goal added since reset
+    // Forget a goal and recompute the tiles that were nearest to it
+    void removeGoal(std::uint16_t id);
+
+    bool covers(TilePos tile) const;
+    std::uint32_t distanceAt(TilePos tile) const; // UNREACHABLE outside the window or when no goal is reachable
+    // NO_GOAL likewise. Between equally near goals, which one a tile reports may
+    // differ between a patched field and a rebuilt one.
+    std::uint16_t nearestGoal(TilePos tile) const;
+    // The neighbour one step closer to the nearest goal; tile itself on a goal or when stuck
+    TilePos next(TilePos tile) const;
+};
+
+#endif // PATHFINDING_H
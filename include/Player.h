@@ -1,21 +1,11 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include <array>
+#include <cstdint>
 #include <string>
-#include <vector>
-#include <map>
 #include "Entity.h"
-
-struct Item
-{
-    std::string name;
-    std::string description;
-    std::string emoji;
-    bool isConsumable;
-
-    Item(const std::string &name, const std::string &description, const std::string &emoji, bool isConsumable)
-        : name(name), description(description), emoji(emoji), isConsumable(isConsumable) {}
-};
+#include "Item.h"
 
 class Player : public Entity
 {
@@ -24,8 +14,7 @@ private:
     int experience;
     int experienceToNextLevel;
     int bdp; // Big Daddy Points (currency)
-    std::vector<Item> inventory;
-    std::map<std::string, int> itemCounts; // Track quantity of each item
+    std::array<std::uint16_t, MAX_ITEM_TYPES> itemCounts; // Quantity held, indexed by ItemId
 
 public:
     Player(const std::string &name);
@@ -35,20 +24,30 @@ public:
     int getExperience() const;
     int getExperienceToNextLevel() const;
     int getBDP() const;
-    const std::vector<Item> &getInventory() const;
-    int getItemCount(const std::string &itemName) const;
+    int getItemCount(ItemId id) const;
+    const std::array<std::uint16_t, MAX_ITEM_TYPES> &getItemCounts() const;
+    bool hasItems() const;
+
+    // Inventory numbering used by the menus: held items in ID order, from 1
+    int getItemSlot(ItemId id) const;     // 0 if the item is not held
+    ItemId getItemAtSlot(int slot) const; // NO_ITEM if there is no such slot
 
     // Setters and modifiers
-    void gainExperience(int amount);
-    void levelUp();
-    void earnBDP(int amount);
-    void spendBDP(int amount);
-    void addItem(const Item &item);
-    bool useItem(const std::string &itemName);
+    void gainExperience(int amount, GameOutput &out);
+    void levelUp(GameOutput &out);
+    void earnBDP(int amount, GameOutput &out);
+    bool spendBDP(int amount, GameOutput &out);
+    void addItem(ItemId id, GameOutput &out);
+    bool useItem(ItemId id, GameOutput &out);
+
+    // Put back state saved in a snapshot
+    void restoreStats(int health, int maxHealth, int attack, int defense,
+                      int level, int experience, int experienceToNextLevel, int bdp);
+    void restoreInventory(const std::array<std::uint16_t, MAX_ITEM_TYPES> &counts);
 
     // Override methods from Entity
-    void displayStats() const override;
-    void displayInventory() const;
+    void displayStats(GameOutput &out) const override;
+    void displayInventory(GameOutput &out) const;
 };
 
 #endif // PLAYER_H
\ No newline at end of file
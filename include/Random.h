@@ -0,0 +1,81 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Counter-based random stream: draw n is a pure function of (key, n), so a
+// stream can be saved, restored or replayed from just its key and counter.
+class RandomStream
+{
+private:
+    std::uint64_t key;
+    std::uint64_t counter;
+
+public:
+    explicit RandomStream(std::uint64_t key = 0, std::uint64_t counter = 0)
+        : key(key), counter(counter) {}
+
+    // SplitMix64 finalizer, a bijective 64-bit mixer
+    static std::uint64_t mix(std::uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    std::uint64_t next()
+    {
+        return mix(key + (++counter) * 0x9e3779b97f4a7c15ULL);
+    }
+
+    // Uniform integer in [low, high] (Lemire's multiply-shift with rejection)
+    int uniformInt(int low, int high)
+    {
+        std::uint32_t range = static_cast<std::uint32_t>(high - low) + 1;
+        std::uint64_t product = static_cast<std::uint32_t>(next()) * static_cast<std::uint64_t>(range);
+        std::uint32_t fraction = static_cast<std::uint32_t>(product);
+        if (fraction < range)
+        {
+            std::uint32_t threshold = (0u - range) % range;
+            while (fraction < threshold)
+            {
+                product = static_cast<std::uint32_t>(next()) * static_cast<std::uint64_t>(range);
+                fraction = static_cast<std::uint32_t>(product);
+            }
+        }
+        return low + static_cast<int>(product >> 32);
+    }
+
+    std::uint64_t getKey() const { return key; }
+    std::uint64_t getCounter() const { return counter; }
+    void setCounter(std::uint64_t value) { counter = value; }
+};
+
+// Per-session random number service: one independent stream per subsystem,
+// all derived from a single 64-bit seed.
+class RandomService
+{
+private:
+    std::uint64_t seed;
+
+public:
+    RandomStream combat;
+    RandomStream loot;
+    RandomStream spawning;
+    RandomStream dialogue;
+
+    explicit RandomService(std::uint64_t seed);
+
+    std::uint64_t getSeed() const;
+
+    // Seed for the index-th child session (e.g. run i of a parallel simulation)
+    static std::uint64_t deriveSeed(std::uint64_t seed, std::uint64_t index);
+
+    // Fresh seed from the OS for interactive play
+    static std::uint64_t entropySeed();
+};
+
+#endif // RANDOM_H
@@ -0,0 +1,75 @@
+#ifndef RECYCLED_SLAB_H
+#define RECYCLED_SLAB_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Contiguous storage for objects that are all discarded together, such as the
+// enemies of one dungeon level. reset() is O(1): it only forgets the live
+// objects. Their slots keep their memory, and the next spawn assigns over a
+// slot instead of allocating.
+template <typename T>
+class RecycledSlab
+{
+private:
+    std::vector<T> slots;    // Slots past live hold stale objects waiting for reuse
+    std::size_t live = 0;
+    std::size_t allocations = 0; // Times the slot storage had to grow
+
+public:
+    // Make room for count live objects up front
+    void reserve(std::size_t count)
+    {
+        if (count > slots.capacity())
+        {
+            slots.reserve(count);
+            allocations++;
+        }
+    }
+
+    template <typename... Args>
+    T &emplace(Args &&...args)
+    {
+        if (live < slots.size())
+        {
+            slots[live] = T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            if (slots.size() == slots.capacity())
+            {
+                allocations++;
+            }
+            slots.emplace_back(std::forward<Args>(args)...);
+        }
+        return slots[live++];
+    }
+
+    void reset() { live = 0; }
+
+    // Replace the live objects with copies of count objects
+    void assign(const T *first, std::size_t count)
+    {
+        reset();
+        reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            emplace(first[i]);
+        }
+    }
+
+    std::size_t size() const { return live; }
+    bool empty() const { return live == 0; }
+    std::size_t getAllocationCount() const { return allocations; }
+
+    T &operator[](std::size_t index) { return slots[index]; }
+    const T &operator[](std::size_t index) const { return slots[index]; }
+
+    T *begin() { return slots.data(); }
+    T *end() { return slots.data() + live; }
+    const T *begin() const { return slots.data(); }
+    const T *end() const { return slots.data() + live; }
+};
+
+#endif // RECYCLED_SLAB_H
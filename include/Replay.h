@@ -0,0 +1,130 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "InputSource.h"
+#include "Output.h"
+#include "Snapshot.h"
+
+class Game;
+
+// Session recording. Layout (native little-endian, 8-byte aligned):
+//
+//   RecordingHeader
+//   RecordHeader + payload (padded to 8 bytes), repeated:
+//     INPUT_LINE   a line the game read, in order
+//     CHECKPOINT   a game snapshot taken between turns
+//
+// The seed plus the input lines reproduce a session exactly, since every
+// random draw comes from the seeded streams, as long as the rules are the
+// same. The header fingerprints the balance parameters, enemy table and
+// dialogue corpus in force when it was recorded, and a replay under any other
+// rules is refused. Checkpoints only make seeking fast.
+
+const std::uint32_t RECORDING_MAGIC = 0x50524344; // "DCRP"
+const std::uint16_t RECORDING_VERSION = 2;
+
+struct RecordingHeader
+{
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t headerSize;
+    std::uint64_t seed;
+    std::uint64_t balanceFingerprint;  // --balance
+    std::uint64_t enemiesFingerprint;  // --enemies
+    std::uint64_t dialogueFingerprint; // --dialogue
+};
+
+// Fingerprints of the rules this process is running with (64-bit FNV-1a)
+std::uint64_t balanceFingerprint();
+std::uint64_t enemiesFingerprint();
+std::uint64_t dialogueFingerprint();
+
+enum class RecordKind : std::uint32_t
+{
+    INPUT_LINE = 1,
+    CHECKPOINT = 2
+};
+
+struct RecordHeader
+{
+    RecordKind kind;
+    std::uint32_t turn;       // Game turn count when recorded
+    std::uint32_t inputIndex; // Lines recorded before this one
+    std::uint32_t size;       // Payload bytes, before padding
+};
+
+// Writes a session to disk as it is played. Every record is flushed straight
+// away, so a crash still leaves a usable recording.
+class SessionRecorder
+{
+private:
+    std::ofstream file;
+    int checkpointEvery;
+    int nextCheckpoint;
+    std::uint32_t linesRecorded;
+    std::vector<char> snapshot; // Reused for every checkpoint
+
+    void writeRecord(RecordKind kind, int turn, const char *payload, std::size_t size);
+
+public:
+    // checkpointEvery is in turns; 0 records input only
+    SessionRecorder(const std::string &path, std::uint64_t seed, int checkpointEvery = 100);
+
+    bool isOpen() const;
+
+    // Called by the game for every line it reads and between turns
+    void recordLine(int turn, std::string_view line);
+    void turnBoundary(const Game &game);
+};
+
+// A replayed game with the input and output it is wired to
+struct ReplayedSession
+{
+    std::unique_ptr<OutputSink> sink;
+    std::unique_ptr<InputSource> input;
+    std::unique_ptr<Game> game;
+    int damagedCheckpoints = 0; // Rejected by the game and skipped for an earlier one
+};
+
+// A loaded recording that can rebuild the session at any turn, at full speed
+// with no terminal I/O or pauses
+class SessionReplay
+{
+private:
+    struct Checkpoint
+    {
+        int turn;
+        std::uint32_t inputIndex;
+        SnapshotView snapshot;
+    };
+
+    std::unique_ptr<MappedFile> file;
+    std::uint64_t seed;
+    std::vector<std::string_view> lines; // Point into the mapped file
+    std::vector<Checkpoint> checkpoints;
+
+public:
+    SessionReplay();
+    ~SessionReplay();
+
+    // False with error set if the file is missing or malformed
+    bool load(const std::string &path, std::string &error);
+
+    std::uint64_t getSeed() const;
+    std::size_t lineCount() const;
+    std::size_t checkpointCount() const;
+
+    // The session at the first turn boundary at or after turn (or at its end),
+    // resumed from the nearest earlier checkpoint the game accepts, or played
+    // from the start. Pass -1 to play to the end.
+    ReplayedSession seek(int turn) const;
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,102 @@
+#ifndef SESSION_HOST_H
+#define SESSION_HOST_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Game.h"
+#include "ThreadPool.h"
+
+struct SessionHostConfig
+{
+    std::size_t threads = 0;    // Worker threads; zero means one per core
+    int stepsPerSlice = 64;     // Steps a session runs before yielding its worker
+    int maxTurnsPerSession = 0; // Bot sessions stop after this many choices (zero: no limit)
+    CombatEventFile *events = nullptr; // Every session spills its combat events here when set; must outlive the host
+};
+
+// How a session ended (or where it stands, if it is still running)
+struct SessionResult
+{
+    GameState state = GameState::MAIN_MENU;
+    bool playerAlive = true;
+    int turns = 0;
+    int dungeonLevel = 1;
+    bool finished = false;
+};
+
+// Runs many independent games in one process. Each session owns its Game,
+// input, output and policy, so sessions share no mutable state; the host only
+// decides which worker steps which session next.
+//
+// Sessions run in slices of stepsPerSlice steps. A player session whose game
+// is suspended at a prompt with no line queued is parked: it holds no thread,
+// only its suspended turn, until sendInput wakes it.
+class SessionHost
+{
+public:
+    using SessionId = std::size_t;
+
+private:
+    struct Session
+    {
+        std::unique_ptr<QueueInput> input; // Null for bot sessions
+        std::unique_ptr<OutputSink> output;
+        std::unique_ptr<DecisionPolicy> policy;
+        std::unique_ptr<Game> game;
+        std::atomic<bool> parked;   // Waiting for input, not queued on the pool
+        std::atomic<bool> finished;
+        SessionResult result;       // Written once, before finished is set
+    };
+
+    SessionHostConfig config;
+    ThreadPool pool;
+
+    // Sessions never move once created; the mutex only guards the vector itself
+    mutable std::mutex sessionsMutex;
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::atomic<std::size_t> finishedCount;
+    std::condition_variable allFinished;
+
+    Session &at(SessionId id) const;
+    SessionId add(std::unique_ptr<Session> session);
+    void runSlice(Session &session);
+    void finish(Session &session);
+    void wake(Session &session);
+
+public:
+    explicit SessionHost(const SessionHostConfig &config = SessionHostConfig());
+    ~SessionHost();
+    SessionHost(const SessionHost &) = delete;
+    SessionHost &operator=(const SessionHost &) = delete;
+
+    // A human player; feed it with sendInput and read its frames from output
+    SessionId addPlayerSession(std::unique_ptr<OutputSink> output,
+                               std::uint64_t seed = RandomService::entropySeed());
+
+    // A game played by policy; output defaults to a NullSink
+    SessionId addBotSession(std::unique_ptr<DecisionPolicy> policy, std::uint64_t seed,
+                            std::unique_ptr<OutputSink> output = nullptr);
+
+    // Thread-safe; lines for a finished session are ignored
+    void sendInput(SessionId id, std::string line);
+    void closeInput(SessionId id);
+
+    // Ask every session to end at its next step
+    void requestExit();
+
+    // Block until every session has finished
+    void wait();
+
+    std::size_t sessionCount() const;
+    std::size_t finishedSessions() const;
+    std::size_t threadCount() const;
+    SessionResult result(SessionId id) const;
+};
+
+#endif // SESSION_HOST_H
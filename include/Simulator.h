@@ -0,0 +1,47 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "DecisionPolicy.h"
+
+struct SimulationConfig
+{
+    long long runs = 100000;
+    int maxTurnsPerRun = 10000; // Runs still going after this many choices count as abandoned
+    std::uint64_t seed = 1;     // Run i plays with RandomService::deriveSeed(seed, i)
+    std::string logPath;        // If set, game text is appended here instead of discarded
+    std::string eventsPath;     // If set, combat events are appended here (CombatEvents.h)
+};
+
+struct SimulationReport
+{
+    std::uint64_t seed = 0;
+    long long runs = 0;
+    long long victories = 0;
+    long long defeats = 0;
+    long long abandoned = 0; // Quit from a menu or hit the turn limit
+    long long totalTurns = 0;
+    double elapsedSeconds = 0.0;
+
+    double winRate() const;
+    double turnsPerRun() const;
+    double runsPerSecond() const;
+    void print(std::ostream &out) const;
+};
+
+// Plays complete headless games back to back with a decision policy
+class Simulator
+{
+private:
+    DecisionPolicy &policy;
+    SimulationConfig config;
+
+public:
+    Simulator(DecisionPolicy &policy, const SimulationConfig &config);
+
+    SimulationReport run();
+};
+
+#endif // SIMULATOR_H
@@ -0,0 +1,151 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Item.h"
+
+// Binary game snapshot, version 4. Layout (native little-endian, 8-byte aligned):
+//
+//   SnapshotHeader                  includes the player and their item counts
+//   SnapshotEnemy [enemyCount]
+//   string table  [stringBytes]     referenced by SnapshotString
+//
+// Every record is fixed-size and plain data, so a snapshot can be read in
+// place from a memory-mapped file. NPCs are rebuilt by the game and not stored.
+
+const std::uint32_t SNAPSHOT_MAGIC = 0x56534344; // "DCSV"
+const std::uint16_t SNAPSHOT_VERSION = 4;
+
+// Slice of the string table
+struct SnapshotString
+{
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+struct SnapshotEntity
+{
+    SnapshotString name;
+    std::int32_t health;
+    std::int32_t maxHealth;
+    std::int32_t attack;
+    std::int32_t defense;
+};
+
+struct SnapshotPlayer
+{
+    SnapshotEntity entity;
+    std::int32_t level;
+    std::int32_t experience;
+    std::int32_t experienceToNextLevel;
+    std::int32_t bdp;
+    std::uint16_t itemCounts[MAX_ITEM_TYPES]; // Indexed by ItemId
+};
+
+// Enemies are saved by archetype name, so a snapshot survives reordering of
+// the content file; their stats are rebuilt from the archetype on load
+struct SnapshotEnemy
+{
+    SnapshotString archetype;
+    std::int32_t level;
+    std::int32_t health;
+};
+
+struct alignas(8) SnapshotHeader
+{
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t headerSize;
+    std::uint32_t totalSize;
+    std::uint32_t enemyCount;
+    std::uint32_t stringBytes;
+
+    std::int32_t state; // GameState
+    std::int32_t currentDungeonLevel;
+    std::int32_t maxDungeonLevel;
+    std::int32_t currentEnemyIndex;
+    std::int32_t turnCount;
+    std::int32_t playerX; // Tile the player stands on; the level's map is rebuilt from the seed
+    std::int32_t playerY;
+
+    std::uint64_t seed;
+    std::uint64_t streamCounters[4]; // combat, loot, spawning, dialogue
+
+    SnapshotPlayer player;
+};
+
+// Read-only view of a snapshot held somewhere else (a buffer or a mapped file).
+// Nothing is copied; accessors point straight into the bytes.
+class SnapshotView
+{
+private:
+    const char *data;
+    std::size_t size;
+    bool valid;
+
+    bool validString(const SnapshotString &text) const;
+    bool validate() const;
+
+public:
+    SnapshotView(const void *data, std::size_t size);
+
+    // Magic, version and every offset checked; the other accessors require this
+    bool isValid() const;
+
+    const SnapshotHeader &header() const;
+    const SnapshotEnemy *enemies() const;
+    std::string_view string(const SnapshotString &text) const;
+};
+
+// Builds a snapshot into a caller-owned buffer, reusing its capacity
+class SnapshotWriter
+{
+private:
+    std::vector<char> &buffer;
+    std::size_t stringsStart;
+
+public:
+    // Lays out the fixed-size part for the given number of enemies
+    SnapshotWriter(std::vector<char> &buffer, std::size_t enemyCount);
+
+    SnapshotHeader &header();
+    SnapshotEnemy &enemy(std::size_t index);
+
+    // Appends text to the string table. Records must be fetched again after
+    // this, since the buffer may move.
+    SnapshotString addString(std::string_view text);
+
+    // Fills in the sizes; the buffer then holds the complete snapshot
+    void finish();
+};
+
+// Whole file mapped read-only into memory (empty if it could not be opened)
+class MappedFile
+{
+private:
+    const char *data;
+    std::size_t size;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isOpen() const;
+    const char *getData() const;
+    std::size_t getSize() const;
+};
+
+// Writes the bytes to path through a temporary file, so a crash never leaves a torn snapshot
+bool writeSnapshotFile(const std::string &path, const std::vector<char> &buffer);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,44 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free single-producer/single-consumer byte ring buffer.
+// One thread may call tryPush(), one other thread may call readable()/consume().
+class SpscByteQueue
+{
+private:
+    std::vector<char> buffer;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> head; // Next byte to read (consumer)
+    alignas(64) std::atomic<std::size_t> tail; // Next byte to write (producer)
+
+public:
+    // Readable bytes as up to two contiguous spans (the second is used when the data wraps)
+    struct Spans
+    {
+        const char *first;
+        std::size_t firstSize;
+        const char *second;
+        std::size_t secondSize;
+
+        std::size_t size() const { return firstSize + secondSize; }
+    };
+
+    // capacity is rounded up to a power of two
+    explicit SpscByteQueue(std::size_t capacity);
+
+    // Producer: copy as much of data as fits, returns the number of bytes queued
+    std::size_t tryPush(const char *data, std::size_t size);
+
+    // Consumer: look at the queued bytes, then release them with consume()
+    Spans readable() const;
+    void consume(std::size_t size);
+
+    bool empty() const;
+    std::size_t capacity() const;
+};
+
+#endif // SPSC_QUEUE_H
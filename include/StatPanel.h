@@ -0,0 +1,49 @@
+#ifndef STAT_PANEL_H
+#define STAT_PANEL_H
+
+#include <array>
+#include <string>
+#include <string_view>
+#include "Output.h"
+
+// Cached text of a stats panel such as Player::displayStats. The panel is
+// identified by the name and numbers it shows: redrawing it unchanged copies
+// the cached text into the frame, and it is formatted again only after one of
+// them changes (damage, healing, a level up, an item). Neither copy allocates
+// once the buffers have grown to the panel's size.
+class StatPanel
+{
+public:
+    using Values = std::array<int, 8>;
+
+private:
+    std::string text;
+    std::string name;
+    Values values{};
+    bool valid = false;
+
+public:
+    // Appends the panel to out; draw writes it to out when it has to be formatted
+    template <typename Draw>
+    void show(GameOutput &out, std::string_view shownName, const Values &shownValues, Draw draw)
+    {
+        if (!out.isEnabled())
+        {
+            return;
+        }
+        if (valid && shownValues == values && shownName == name)
+        {
+            out << text;
+            return;
+        }
+
+        std::size_t start = out.framePosition();
+        draw();
+        text.assign(out.textSince(start));
+        name.assign(shownName);
+        values = shownValues;
+        valid = true;
+    }
+};
+
+#endif // STAT_PANEL_H
@@ -0,0 +1,187 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Lazily started coroutine that produces a T for whoever co_awaits it.
+// Awaiting a Task runs it straight away on the same thread; when it finishes
+// (or throws) control transfers back to the awaiting coroutine without growing
+// the stack. A suspension anywhere in the chain returns to whoever resumed it.
+template <typename T>
+class Task;
+
+namespace detail
+{
+    // Coroutine frames come and go on every turn; recycle them per thread
+    // instead of going through the heap each time
+    void *allocateFrame(std::size_t size);
+    void freeFrame(void *frame, std::size_t size) noexcept;
+
+    struct TaskPromiseBase
+    {
+        static void *operator new(std::size_t size) { return allocateFrame(size); }
+        static void operator delete(void *frame, std::size_t size) noexcept { freeFrame(frame, size); }
+
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+
+        struct FinalAwaiter
+        {
+            bool await_ready() const noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> finished) noexcept
+            {
+                std::coroutine_handle<> next = finished.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void unhandled_exception() { exception = std::current_exception(); }
+
+        void rethrowIfFailed() const
+        {
+            if (exception)
+            {
+                std::rethrow_exception(exception);
+            }
+        }
+    };
+
+    template <typename T>
+    struct TaskPromise : TaskPromiseBase
+    {
+        std::optional<T> value;
+
+        Task<T> get_return_object();
+        void return_value(T result) { value = std::move(result); }
+
+        T take()
+        {
+            rethrowIfFailed();
+            return std::move(*value);
+        }
+    };
+
+    template <>
+    struct TaskPromise<void> : TaskPromiseBase
+    {
+        Task<void> get_return_object();
+        void return_void() const noexcept {}
+
+        void take() const { rethrowIfFailed(); }
+    };
+
+    // Result of a task that finished without running a coroutine
+    template <typename T>
+    struct ReadyValue
+    {
+        std::optional<T> value;
+
+        T take() { return std::move(*value); }
+    };
+
+    template <>
+    struct ReadyValue<void>
+    {
+        void take() const {}
+    };
+}
+
+template <typename T = void>
+class Task
+{
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+private:
+    std::coroutine_handle<promise_type> handle; // Null for a completed() task
+    detail::ReadyValue<T> ready;
+
+public:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)), ready(std::move(other.ready)) {}
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, nullptr);
+            ready = std::move(other.ready);
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    // A task that has already finished: awaiting it runs no coroutine and
+    // allocates nothing (fast paths such as a bot's menu choice)
+    template <typename... Value>
+    static Task completed(Value &&...value)
+    {
+        Task task(nullptr);
+        if constexpr (!std::is_void_v<T>)
+        {
+            task.ready.value.emplace(std::forward<Value>(value)...);
+        }
+        return task;
+    }
+
+    // Driving a top-level task by hand (Game::step)
+    void resume()
+    {
+        if (handle)
+        {
+            handle.resume();
+        }
+    }
+    bool done() const { return !handle || handle.done(); }
+    T result() { return handle ? handle.promise().take() : ready.take(); }
+
+    // co_await task: start it and continue here once it finishes
+    bool await_ready() const noexcept { return !handle; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume() { return result(); }
+};
+
+namespace detail
+{
+    template <typename T>
+    Task<T> TaskPromise<T>::get_return_object()
+    {
+        return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object()
+    {
+        return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+    }
+}
+
+#endif // TASK_H
@@ -0,0 +1,43 @@
+#ifndef TERMINAL_RENDERER_H
+#define TERMINAL_RENDERER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Output.h"
+
+// Number of terminal columns a UTF-8 string occupies, counting emoji
+// (including VS16 and ZWJ sequences) and East Asian wide characters as 2
+int displayWidth(std::string_view utf8);
+
+// Terminal sink that keeps a model of what is on screen and, for every frame,
+// rewrites only the lines that changed using ANSI cursor addressing. Each
+// update leaves in a single write(); a screen that no longer fits the
+// terminal falls back to a full repaint.
+class TerminalRenderer : public OutputSink
+{
+private:
+    TerminalSink terminal;
+    std::vector<std::string> screen;  // Lines the terminal currently shows
+    std::vector<std::string> pending; // Screen being composed since the last clear
+    std::vector<int> screenRowStarts; // First terminal row of each line in screen
+    bool fullRedraw;
+    int columns;
+    int rows;
+    std::string update; // Escape sequences for one present()
+
+    void append(std::vector<std::string> &lines, std::string_view text);
+    int rowsFor(const std::string &line) const;
+    void querySize();
+    void present();
+
+public:
+    TerminalRenderer();
+
+    void writeFrame(std::string_view frame) override;
+    void clearScreen() override;
+    void noteInput(std::string_view line) override;
+    void drain() override;
+};
+
+#endif // TERMINAL_RENDERER_H
@@ -0,0 +1,59 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. A worker runs its
+// newest task first (the session it just touched is still in cache) and, when
+// its deque is empty, steals the oldest task from another worker.
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<std::size_t> queued;     // Tasks waiting in some deque
+    std::atomic<std::size_t> unfinished; // Tasks submitted but not yet finished
+    std::atomic<std::size_t> nextWorker; // Round-robin target for outside submissions
+    std::atomic<bool> stopping;
+    std::mutex sleepMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+
+    bool popLocal(std::size_t index, Task &task);
+    bool steal(std::size_t thief, Task &task);
+    void workerLoop(std::size_t index);
+
+public:
+    // Zero threads means one per hardware core
+    explicit ThreadPool(std::size_t threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Queue a task; from a worker it goes on that worker's own deque
+    void submit(Task task);
+
+    // Block until every submitted task (including ones they submitted) has finished
+    void wait();
+
+    std::size_t size() const;
+};
+
+#endif // THREAD_POOL_H
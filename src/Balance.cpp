@@ -0,0 +1,137 @@
+#include "Balance.h"
+#include <charconv>
+#include <fstream>
+
+namespace
+{
+    constexpr BalanceField FIELDS[] = {
+        {"level_up_health", &BalanceParams::levelUpHealth, 0, 100},
+        {"level_up_attack", &BalanceParams::levelUpAttack, 0, 30},
+        {"level_up_defense", &BalanceParams::levelUpDefense, 0, 20},
+        {"experience_per_level", &BalanceParams::experiencePerLevel, 10, 1000},
+        {"enemy_health_percent", &BalanceParams::enemyHealthPercent, 10, 400},
+        {"enemy_attack_percent", &BalanceParams::enemyAttackPercent, 10, 400},
+        {"enemy_defense_percent", &BalanceParams::enemyDefensePercent, 0, 400},
+        {"boss_health_percent", &BalanceParams::bossHealthPercent, 10, 400},
+        {"boss_attack_percent", &BalanceParams::bossAttackPercent, 10, 400},
+        {"boss_defense_percent", &BalanceParams::bossDefensePercent, 0, 400},
+        {"potion_price", &BalanceParams::potionPrice, 1, 500},
+        {"attack_boost_price", &BalanceParams::attackBoostPrice, 1, 500},
+        {"defense_boost_price", &BalanceParams::defenseBoostPrice, 1, 500},
+        {"potion_drop_in_ten", &BalanceParams::potionDropInTen, 0, 10},
+        {"escape_in_ten", &BalanceParams::escapeInTen, 0, 10},
+        {"defend_bonus", &BalanceParams::defendBonus, 0, 50},
+    };
+
+    constexpr std::size_t FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+    static_assert(FIELD_COUNT * sizeof(int) == sizeof(BalanceParams), "every balance parameter needs a field entry");
+
+    BalanceParams current;
+
+    std::string_view trim(std::string_view text)
+    {
+        std::size_t start = text.find_first_not_of(" \t\r");
+        if (start == std::string_view::npos)
+        {
+            return {};
+        }
+        std::size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(start, end - start + 1);
+    }
+}
+
+const BalanceParams &Balance::get()
+{
+    return current;
+}
+
+void Balance::set(const BalanceParams &params)
+{
+    current = params;
+}
+
+const BalanceField *Balance::fields()
+{
+    return FIELDS;
+}
+
+std::size_t Balance::fieldCount()
+{
+    return FIELD_COUNT;
+}
+
+const BalanceField *Balance::findField(std::string_view name)
+{
+    for (const BalanceField &field : FIELDS)
+    {
+        if (field.name == name)
+        {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+bool Balance::loadFile(const std::string &path, BalanceParams &params, std::string &error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    BalanceParams loaded;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        std::string_view content = trim(std::string_view(line).substr(0, line.find('#')));
+        if (content.empty())
+        {
+            continue;
+        }
+
+        std::size_t space = content.find_first_of(" \t");
+        std::string_view name = content.substr(0, space);
+        std::string_view text = space == std::string_view::npos ? std::string_view() : trim(content.substr(space));
+        const BalanceField *field = findField(name);
+        int value = 0;
+        auto [end, parseError] = std::from_chars(text.data(), text.data() + text.size(), value);
+        std::string problem;
+        if (!field)
+        {
+            problem = "unknown parameter " + std::string(name);
+        }
+        else if (text.empty() || parseError != std::errc() || end != text.data() + text.size())
+        {
+            problem = "expected <name> <whole number>";
+        }
+        else if (value < field->low || value > field->high)
+        {
+            problem = std::string(name) + " must be between " + std::to_string(field->low) +
+                      " and " + std::to_string(field->high);
+        }
+        if (!problem.empty())
+        {
+            error = path + ":" + std::to_string(lineNumber) + ": " + problem;
+            return false;
+        }
+        loaded.*(field->member) = value;
+    }
+
+    params = loaded;
+    return true;
+}
+
+bool Balance::saveFile(const std::string &path, const BalanceParams &params)
+{
+    std::ofstream file(path);
+    file << "# Balance parameters for dungeon_crawler --balance " << path << '\n';
+    for (const BalanceField &field : FIELDS)
+    {
+        file << field.name << ' ' << params.*(field.member) << '\n';
+    }
+    return static_cast<bool>(file.flush());
+}
@@ -0,0 +1,424 @@
+#include "CombatAdvisor.h"
+#include "Balance.h"
+#include "Enemy.h"
+#include "Game.h"
+#include "Player.h"
+#include "Random.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const double EXPLORATION = 0.7;          // UCB1 constant; values lie in [0, 1]
+    const std::size_t MAX_TREE_NODES = 1 << 16; // Per thread; past this, leaves are only rolled out
+    const int MAX_ROLLOUT_MOVES = 2000;      // A fight this long counts as lost
+    const int CLOCK_CHECK_EVERY = 16;        // Iterations between deadline checks
+
+    // Same rule as Entity/Enemy::calculateDamage followed by takeDamage
+    int hit(int attack, int defense, RandomStream &rng)
+    {
+        int damage = std::max(1, attack + rng.uniformInt(-2, 2));
+        return std::max(1, damage - defense);
+    }
+
+    // Health the held healing items would restore
+    int healingHeld(const CombatState &state)
+    {
+        int healing = 0;
+        for (std::size_t id = 0; id < ItemRegistry::size(); ++id)
+        {
+            const ItemInfo &item = ItemRegistry::get(static_cast<ItemId>(id));
+            if (item.effect == ItemEffect::HEAL_PERCENT)
+            {
+                healing += state.itemCounts[id] * (state.maxHealth * item.amount / 100);
+            }
+        }
+        return healing;
+    }
+
+    double value(const CombatState &state, CombatOutcome outcome)
+    {
+        if (outcome == CombatOutcome::LOST || outcome == CombatOutcome::ONGOING)
+        {
+            return 0.0;
+        }
+        // Items count for half, since using them later costs turns
+        double resources = std::min(1.0, (state.health + 0.5 * healingHeld(state)) / std::max(1, state.maxHealth));
+        double won = 0.5 + 0.5 * resources;
+        return outcome == CombatOutcome::WON ? won : 0.25 * won;
+    }
+
+    // Heal when low, drink boosts while they are free, otherwise attack
+    CombatMove rolloutMove(const CombatState &state)
+    {
+        bool low = state.health * 100 < state.maxHealth * 35;
+        for (std::size_t id = 0; id < ItemRegistry::size(); ++id)
+        {
+            if (state.itemCounts[id] == 0)
+            {
+                continue;
+            }
+            ItemEffect effect = ItemRegistry::get(static_cast<ItemId>(id)).effect;
+            if ((effect == ItemEffect::HEAL_PERCENT && low) ||
+                effect == ItemEffect::ATTACK_BONUS || effect == ItemEffect::DEFENSE_BONUS)
+            {
+                return {CombatAction::USE_ITEM, static_cast<ItemId>(id)};
+            }
+        }
+        return {CombatAction::ATTACK, NO_ITEM};
+    }
+
+    double rollout(CombatState state, CombatOutcome outcome, RandomStream &rng)
+    {
+        for (int moves = 0; outcome == CombatOutcome::ONGOING && moves < MAX_ROLLOUT_MOVES; ++moves)
+        {
+            outcome = state.apply(rolloutMove(state), rng);
+        }
+        return value(state, outcome);
+    }
+
+    struct Node
+    {
+        CombatMove move;
+        std::uint8_t childCount;
+        std::int32_t parent;
+        std::int32_t firstChild; // -1 until expanded
+        std::uint64_t visits;
+        double totalValue;
+    };
+
+    struct RootStats
+    {
+        std::array<CombatMove, MAX_COMBAT_MOVES> moves;
+        std::array<std::uint64_t, MAX_COMBAT_MOVES> visits{};
+        std::array<double, MAX_COMBAT_MOVES> totals{};
+        std::size_t moveCount = 0;
+        std::uint64_t rollouts = 0;
+    };
+
+    std::int32_t selectChild(const std::vector<Node> &tree, const Node &node)
+    {
+        double logVisits = std::log(static_cast<double>(node.visits));
+        std::int32_t best = node.firstChild;
+        double bestScore = -1.0;
+        for (std::int32_t child = node.firstChild; child < node.firstChild + node.childCount; ++child)
+        {
+            const Node &candidate = tree[child];
+            if (candidate.visits == 0)
+            {
+                return child;
+            }
+            double score = candidate.totalValue / candidate.visits +
+                           EXPLORATION * std::sqrt(logVisits / candidate.visits);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                best = child;
+            }
+        }
+        return best;
+    }
+
+    void expand(std::vector<Node> &tree, std::int32_t index, const CombatState &state)
+    {
+        CombatMove moves[MAX_COMBAT_MOVES];
+        std::size_t count = state.legalMoves(moves);
+        tree[index].firstChild = static_cast<std::int32_t>(tree.size());
+        tree[index].childCount = static_cast<std::uint8_t>(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            tree.push_back(Node{moves[i], 0, index, -1, 0, 0.0});
+        }
+    }
+
+    // One thread's search: grow a tree until the deadline or the rollout quota
+    void search(const CombatState &root, std::uint64_t key, std::uint64_t quota,
+                std::chrono::steady_clock::time_point deadline, bool timed, RootStats &result)
+    {
+        thread_local std::vector<Node> tree;
+        tree.clear();
+        tree.reserve(1024);
+        tree.push_back(Node{{CombatAction::ATTACK, NO_ITEM}, 0, -1, -1, 0, 0.0});
+        expand(tree, 0, root);
+
+        RandomStream rng(key);
+        std::uint64_t rollouts = 0;
+        while (quota == 0 || rollouts < quota)
+        {
+            if (timed && rollouts % CLOCK_CHECK_EVERY == 0 && std::chrono::steady_clock::now() >= deadline)
+            {
+                break;
+            }
+
+            // Selection: replay the path with fresh dice
+            CombatState state = root;
+            CombatOutcome outcome = CombatOutcome::ONGOING;
+            std::int32_t index = 0;
+            while (outcome == CombatOutcome::ONGOING && tree[index].firstChild >= 0)
+            {
+                index = selectChild(tree, tree[index]);
+                outcome = state.apply(tree[index].move, rng);
+            }
+
+            // Expansion: one new level under a node that has been visited before
+            if (outcome == CombatOutcome::ONGOING && tree[index].visits > 0 && tree.size() + MAX_COMBAT_MOVES <= MAX_TREE_NODES)
+            {
+                expand(tree, index, state);
+                index = tree[index].firstChild;
+                outcome = state.apply(tree[index].move, rng);
+            }
+
+            double reward = rollout(state, outcome, rng);
+            for (std::int32_t node = index; node >= 0; node = tree[node].parent)
+            {
+                tree[node].visits++;
+                tree[node].totalValue += reward;
+            }
+            rollouts++;
+        }
+
+        const Node &top = tree[0];
+        result.moveCount = top.childCount;
+        for (std::size_t i = 0; i < top.childCount; ++i)
+        {
+            const Node &child = tree[top.firstChild + i];
+            result.moves[i] = child.move;
+            result.visits[i] = child.visits;
+            result.totals[i] = child.totalValue;
+        }
+        result.rollouts = rollouts;
+    }
+}
+
+CombatState CombatState::from(const Player &player, const Enemy &enemy)
+{
+    CombatState state;
+    state.health = player.getHealth();
+    state.maxHealth = player.getMaxHealth();
+    state.attack = player.getAttack();
+    state.defense = player.getDefense();
+    state.enemyHealth = enemy.getHealth();
+    state.enemyAttack = enemy.getAttack();
+    state.enemyDefense = enemy.getDefense();
+    state.enemyIsBoss = enemy.getIsBoss();
+    state.itemCounts = player.getItemCounts();
+    return state;
+}
+
+std::size_t CombatState::legalMoves(CombatMove *moves) const
+{
+    std::size_t count = 0;
+    moves[count++] = {CombatAction::ATTACK, NO_ITEM};
+    moves[count++] = {CombatAction::DEFEND, NO_ITEM};
+    for (std::size_t id = 0; id < ItemRegistry::size(); ++id)
+    {
+        if (itemCounts[id] > 0 && ItemRegistry::get(static_cast<ItemId>(id)).effect != ItemEffect::NONE)
+        {
+            moves[count++] = {CombatAction::USE_ITEM, static_cast<ItemId>(id)};
+        }
+    }
+    moves[count++] = {CombatAction::RUN_AWAY, NO_ITEM};
+    return count;
+}
+
+CombatOutcome CombatState::apply(const CombatMove &move, RandomStream &rng)
+{
+    switch (move.action)
+    {
+    case CombatAction::ATTACK:
+        enemyHealth = std::max(0, enemyHealth - hit(attack, enemyDefense, rng));
+        if (enemyHealth == 0)
+        {
+            return CombatOutcome::WON;
+        }
+        break;
+    case CombatAction::DEFEND:
+    {
+        // The stance takes the defend bonus off the enemy's roll, then defense applies as usual
+        int damage = std::max(1, std::max(1, enemyAttack + rng.uniformInt(-2, 2)) - Balance::get().defendBonus);
+        health = std::max(0, health - std::max(1, damage - defense));
+        return health == 0 ? CombatOutcome::LOST : CombatOutcome::ONGOING;
+    }
+    case CombatAction::USE_ITEM:
+    {
+        // Using an item costs the player's turn but the enemy does not reply
+        const ItemInfo &item = ItemRegistry::get(move.item);
+        switch (item.effect)
+        {
+        case ItemEffect::HEAL_PERCENT:
+            health = std::min(maxHealth, health + maxHealth * item.amount / 100);
+            break;
+        case ItemEffect::ATTACK_BONUS:
+            attack += item.amount;
+            break;
+        case ItemEffect::DEFENSE_BONUS:
+            defense += item.amount;
+            break;
+        case ItemEffect::NONE:
+            break;
+        }
+        if (item.isConsumable)
+        {
+            itemCounts[move.item]--;
+        }
+        return CombatOutcome::ONGOING;
+    }
+    case CombatAction::RUN_AWAY:
+        // Bosses never stop you leaving (see Game::handleCombat)
+        if (rng.uniformInt(1, 10) > 10 - Balance::get().escapeInTen || enemyIsBoss)
+        {
+            return CombatOutcome::ESCAPED;
+        }
+        break;
+    }
+
+    // The enemy strikes back
+    health = std::max(0, health - hit(enemyAttack, defense, rng));
+    return health == 0 ? CombatOutcome::LOST : CombatOutcome::ONGOING;
+}
+
+CombatAdvisor::CombatAdvisor(const AdvisorConfig &config)
+    : config(config), searches(0)
+{
+    if (this->config.threads == 0)
+    {
+        this->config.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (this->config.threads > 1)
+    {
+        pool = std::make_unique<ThreadPool>(this->config.threads);
+    }
+}
+
+CombatAdvisor::~CombatAdvisor() = default;
+
+CombatAdvice CombatAdvisor::advise(const CombatState &state)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + config.budget;
+    bool timed = config.budget.count() > 0;
+    std::uint64_t searchSeed = RandomService::deriveSeed(config.seed, searches++);
+
+    // With neither limit set, fall back to the default budget rather than search forever
+    if (!timed && config.maxRollouts == 0)
+    {
+        deadline = start + AdvisorConfig().budget;
+        timed = true;
+    }
+
+    unsigned threads = config.threads;
+    std::vector<RootStats> results(threads);
+    auto quotaFor = [&](unsigned worker) -> std::uint64_t
+    {
+        if (config.maxRollouts == 0)
+        {
+            return 0;
+        }
+        std::uint64_t quota = config.maxRollouts / threads + (worker < config.maxRollouts % threads ? 1 : 0);
+        return std::max<std::uint64_t>(quota, 1);
+    };
+
+    if (!pool)
+    {
+        search(state, RandomService::deriveSeed(searchSeed, 0), quotaFor(0), deadline, timed, results[0]);
+    }
+    else
+    {
+        for (unsigned worker = 0; worker < threads; ++worker)
+        {
+            pool->submit([&, worker]
+                         { search(state, RandomService::deriveSeed(searchSeed, worker), quotaFor(worker),
+                                  deadline, timed, results[worker]); });
+        }
+        pool->wait();
+    }
+
+    // Every tree has the same root moves in the same order
+    CombatAdvice advice{};
+    advice.moveCount = results[0].moveCount;
+    std::size_t best = 0;
+    for (std::size_t i = 0; i < advice.moveCount; ++i)
+    {
+        std::uint64_t visits = 0;
+        double total = 0.0;
+        for (const RootStats &result : results)
+        {
+            visits += result.visits[i];
+            total += result.totals[i];
+        }
+        advice.moves[i] = {results[0].moves[i], visits, visits ? total / visits : 0.0};
+        if (visits > advice.moves[best].visits)
+        {
+            best = i;
+        }
+    }
+    for (const RootStats &result : results)
+    {
+        advice.rollouts += result.rollouts;
+    }
+    advice.best = advice.moves[best].move;
+    advice.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return advice;
+}
+
+CombatAdvice CombatAdvisor::advise(const Player &player, const Enemy &enemy)
+{
+    return advise(CombatState::from(player, enemy));
+}
+
+const AdvisorConfig &CombatAdvisor::getConfig() const
+{
+    return config;
+}
+
+MctsPolicy::MctsPolicy(const AdvisorConfig &config)
+    : advisor(config), pendingItem(NO_ITEM)
+{
+}
+
+int MctsPolicy::choose(const Game &game, ChoicePrompt prompt)
+{
+    const Enemy *enemy = game.getCurrentEnemy();
+    if (prompt == ChoicePrompt::COMBAT && enemy)
+    {
+        CombatMove move = advisor.advise(game.getPlayer(), *enemy).best;
+        switch (move.action)
+        {
+        case CombatAction::ATTACK:
+            return 1;
+        case CombatAction::DEFEND:
+            return 2;
+        case CombatAction::USE_ITEM:
+            pendingItem = move.item;
+            return 3;
+        case CombatAction::RUN_AWAY:
+            return 5;
+        }
+    }
+    if (prompt == ChoicePrompt::USE_ITEM && pendingItem != NO_ITEM)
+    {
+        int slot = game.getPlayer().getItemSlot(pendingItem);
+        pendingItem = NO_ITEM;
+        return slot;
+    }
+    return fallback.choose(game, prompt);
+}
+
+const char *combatMoveName(const CombatMove &move)
+{
+    switch (move.action)
+    {
+    case CombatAction::ATTACK:
+        return "Attack";
+    case CombatAction::DEFEND:
+        return "Defend";
+    case CombatAction::USE_ITEM:
+        return "Use item";
+    case CombatAction::RUN_AWAY:
+        return "Run away";
+    }
+    return "";
+}
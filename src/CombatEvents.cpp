@@ -0,0 +1,103 @@
+#include "CombatEvents.h"
+#include "Output.h"
+
+std::string_view combatEventTypeName(CombatEventType type)
+{
+    switch (type)
+    {
+    case CombatEventType::DAMAGE:
+        return "damage";
+    case CombatEventType::HEAL:
+        return "heal";
+    case CombatEventType::EXPERIENCE:
+        return "experience";
+    case CombatEventType::BDP:
+        return "bdp";
+    case CombatEventType::ITEM_DROP:
+        return "item_drop";
+    case CombatEventType::LEVEL_UP:
+        return "level_up";
+    case CombatEventType::STATE_TRANSITION:
+        return "state_transition";
+    case CombatEventType::COUNT:
+        break;
+    }
+    return "unknown";
+}
+
+CombatEventFile::CombatEventFile(const std::string &path)
+    : sink(std::make_unique<AsyncFileSink>(path)) {}
+
+// The sink's writer finishes every queued block before it closes the file
+CombatEventFile::~CombatEventFile() = default;
+
+bool CombatEventFile::isOpen() const
+{
+    return sink->isOpen();
+}
+
+void CombatEventFile::append(const CombatEvent *events, std::size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    CombatEventBlockHeader header{COMBAT_EVENT_MAGIC, COMBAT_EVENT_VERSION, sizeof(CombatEvent),
+                                  static_cast<std::uint32_t>(count), 0};
+    std::lock_guard<std::mutex> lock(mutex);
+    sink->writeFrame(std::string_view(reinterpret_cast<const char *>(&header), sizeof(header)));
+    sink->writeFrame(std::string_view(reinterpret_cast<const char *>(events), count * sizeof(CombatEvent)));
+}
+
+void CombatEventLog::spill()
+{
+    // Without a file the ring may have lapped events that were never spilled; those are gone
+    std::uint32_t pending = written - spilled;
+    if (pending > CAPACITY)
+    {
+        pending = CAPACITY;
+    }
+    std::size_t first = (written - pending) & (CAPACITY - 1);
+    std::size_t contiguous = CAPACITY - first < pending ? CAPACITY - first : pending;
+    file->append(ring + first, contiguous);
+    file->append(ring, pending - contiguous);
+    spilled = written;
+}
+
+void CombatEventLog::setFile(CombatEventFile *eventFile)
+{
+    flush();
+    file = eventFile;
+    spilled = written; // Events from before the file was attached stay in the ring only
+}
+
+void CombatEventLog::flush()
+{
+    if (file && written != spilled)
+    {
+        spill();
+    }
+}
+
+CombatEventReader::CombatEventReader(const void *data, std::size_t size)
+    : data(static_cast<const char *>(data)), size(size) {}
+
+std::span<const CombatEvent> CombatEventReader::nextBlock()
+{
+    if (damaged || offset == size)
+    {
+        return {};
+    }
+    const auto *header = reinterpret_cast<const CombatEventBlockHeader *>(data + offset);
+    if (size - offset < sizeof(CombatEventBlockHeader) || header->magic != COMBAT_EVENT_MAGIC ||
+        header->version != COMBAT_EVENT_VERSION || header->recordSize != sizeof(CombatEvent) ||
+        header->count > (size - offset - sizeof(CombatEventBlockHeader)) / sizeof(CombatEvent) ||
+        reinterpret_cast<std::uintptr_t>(data + offset) % alignof(CombatEvent) != 0)
+    {
+        damaged = true;
+        return {};
+    }
+    const auto *records = reinterpret_cast<const CombatEvent *>(data + offset + sizeof(CombatEventBlockHeader));
+    offset += sizeof(CombatEventBlockHeader) + header->count * sizeof(CombatEvent);
+    return {records, header->count};
+}
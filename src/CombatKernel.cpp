@@ -0,0 +1,199 @@
+#include "CombatKernel.h"
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COMBAT_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+std::size_t CombatantArrays::size() const
+{
+    return health.size();
+}
+
+void CombatantArrays::reserve(std::size_t count)
+{
+    health.reserve(count);
+    maxHealth.reserve(count);
+    attack.reserve(count);
+    defense.reserve(count);
+}
+
+void CombatantArrays::clear()
+{
+    health.clear();
+    maxHealth.clear();
+    attack.clear();
+    defense.clear();
+}
+
+std::size_t CombatantArrays::add(int newHealth, int newAttack, int newDefense)
+{
+    health.push_back(newHealth);
+    maxHealth.push_back(newHealth);
+    attack.push_back(newAttack);
+    defense.push_back(newDefense);
+    return health.size() - 1;
+}
+
+namespace
+{
+    // Arguments shared by every kernel variant
+    struct ExchangeBatch
+    {
+        const std::int32_t *attack;
+        const std::int32_t *defense;
+        const std::int32_t *rolls;
+        std::int32_t *health;
+        std::int32_t *damageDealt;
+        std::size_t count;
+    };
+
+    void resolveScalar(const ExchangeBatch &batch, std::size_t begin)
+    {
+        for (std::size_t i = begin; i < batch.count; ++i)
+        {
+            std::int32_t damage = std::max(batch.attack[i] + batch.rolls[i], 1); // Minimum damage is 1
+            std::int32_t dealt = std::max(damage - batch.defense[i], 1);
+            batch.health[i] = std::max(batch.health[i] - dealt, 0);
+            if (batch.damageDealt)
+            {
+                batch.damageDealt[i] = dealt;
+            }
+        }
+    }
+
+#ifdef COMBAT_KERNEL_X86
+    __attribute__((target("sse4.1"))) void resolveSse41(const ExchangeBatch &batch)
+    {
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i zero = _mm_setzero_si128();
+
+        std::size_t i = 0;
+        for (; i + 4 <= batch.count; i += 4)
+        {
+            __m128i attack = _mm_loadu_si128(reinterpret_cast<const __m128i *>(batch.attack + i));
+            __m128i roll = _mm_loadu_si128(reinterpret_cast<const __m128i *>(batch.rolls + i));
+            __m128i defense = _mm_loadu_si128(reinterpret_cast<const __m128i *>(batch.defense + i));
+            __m128i health = _mm_loadu_si128(reinterpret_cast<const __m128i *>(batch.health + i));
+
+            __m128i damage = _mm_max_epi32(_mm_add_epi32(attack, roll), one);
+            __m128i dealt = _mm_max_epi32(_mm_sub_epi32(damage, defense), one);
+            health = _mm_max_epi32(_mm_sub_epi32(health, dealt), zero);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(batch.health + i), health);
+            if (batch.damageDealt)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(batch.damageDealt + i), dealt);
+            }
+        }
+        resolveScalar(batch, i);
+    }
+
+    __attribute__((target("avx2"))) void resolveAvx2(const ExchangeBatch &batch)
+    {
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i zero = _mm256_setzero_si256();
+
+        std::size_t i = 0;
+        for (; i + 8 <= batch.count; i += 8)
+        {
+            __m256i attack = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(batch.attack + i));
+            __m256i roll = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(batch.rolls + i));
+            __m256i defense = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(batch.defense + i));
+            __m256i health = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(batch.health + i));
+
+            __m256i damage = _mm256_max_epi32(_mm256_add_epi32(attack, roll), one);
+            __m256i dealt = _mm256_max_epi32(_mm256_sub_epi32(damage, defense), one);
+            health = _mm256_max_epi32(_mm256_sub_epi32(health, dealt), zero);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(batch.health + i), health);
+            if (batch.damageDealt)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(batch.damageDealt + i), dealt);
+            }
+        }
+        resolveScalar(batch, i);
+    }
+#endif
+}
+
+CombatKernelIsa detectCombatKernelIsa()
+{
+    static const CombatKernelIsa detected = []
+    {
+#ifdef COMBAT_KERNEL_X86
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return CombatKernelIsa::AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.1"))
+        {
+            return CombatKernelIsa::SSE41;
+        }
+#endif
+        return CombatKernelIsa::SCALAR;
+    }();
+    return detected;
+}
+
+bool isCombatKernelIsaSupported(CombatKernelIsa isa)
+{
+    return static_cast<int>(isa) <= static_cast<int>(detectCombatKernelIsa());
+}
+
+const char *combatKernelIsaName(CombatKernelIsa isa)
+{
+    switch (isa)
+    {
+    case CombatKernelIsa::SCALAR:
+        return "scalar";
+    case CombatKernelIsa::SSE41:
+        return "sse4.1";
+    case CombatKernelIsa::AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+void rollDamageModifiers(RandomStream &rng, std::int32_t *rolls, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        rolls[i] = rng.uniformInt(-2, 2); // Random modifier between -2 and +2
+    }
+}
+
+void resolveExchanges(const CombatantArrays &attackers, CombatantArrays &defenders,
+                      const std::int32_t *rolls, std::int32_t *damageDealt)
+{
+    resolveExchanges(attackers, defenders, rolls, damageDealt, detectCombatKernelIsa());
+}
+
+void resolveExchanges(const CombatantArrays &attackers, CombatantArrays &defenders,
+                      const std::int32_t *rolls, std::int32_t *damageDealt, CombatKernelIsa isa)
+{
+    ExchangeBatch batch{attackers.attack.data(), defenders.defense.data(), rolls,
+                        defenders.health.data(), damageDealt,
+                        std::min(attackers.size(), defenders.size())};
+
+    if (!isCombatKernelIsaSupported(isa))
+    {
+        isa = detectCombatKernelIsa();
+    }
+
+    switch (isa)
+    {
+#ifdef COMBAT_KERNEL_X86
+    case CombatKernelIsa::AVX2:
+        resolveAvx2(batch);
+        return;
+    case CombatKernelIsa::SSE41:
+        resolveSse41(batch);
+        return;
+#endif
+    default:
+        resolveScalar(batch, 0);
+        return;
+    }
+}
@@ -0,0 +1,123 @@
+#include "Commands.h"
+#include <array>
+#include <charconv>
+
+namespace
+{
+    constexpr CommandSpec COMMANDS[] = {
+        {"/status", CommandId::STATUS, "Display player stats"},
+        {"/stats", CommandId::STATUS, ""},
+        {"/inventory", CommandId::INVENTORY, "Display inventory"},
+        {"/inv", CommandId::INVENTORY, ""},
+        {"/help", CommandId::HELP, "Show this help message"},
+        {"/exit", CommandId::EXIT, "Exit the game"},
+        {"/advise", CommandId::ADVISE, "Ask the advisor for the best combat move"},
+        {"/hint", CommandId::ADVISE, ""},
+        {"/map", CommandId::MAP, "Show the dungeon map around you"},
+    };
+
+    constexpr std::size_t COMMAND_SPECS = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+    // Power of two, at least twice the number of spellings
+    constexpr std::size_t HASH_SLOTS = [] {
+        std::size_t slots = 1;
+        while (slots < 2 * COMMAND_SPECS)
+        {
+            slots *= 2;
+        }
+        return slots;
+    }();
+
+    // Seeded FNV-1a
+    constexpr std::uint32_t hashName(std::string_view name, std::uint32_t seed)
+    {
+        std::uint32_t hash = 2166136261u ^ seed;
+        for (char c : name)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    struct PerfectHash
+    {
+        std::uint32_t seed = 0;
+        std::array<std::uint8_t, HASH_SLOTS> slots{}; // Index into COMMANDS plus one; zero is empty
+    };
+
+    // Try seeds until every spelling lands in its own slot
+    constexpr PerfectHash buildPerfectHash()
+    {
+        for (std::uint32_t seed = 0; seed < 100000; ++seed)
+        {
+            PerfectHash table;
+            table.seed = seed;
+            bool collided = false;
+            for (std::size_t i = 0; i < COMMAND_SPECS && !collided; ++i)
+            {
+                std::uint8_t &slot = table.slots[hashName(COMMANDS[i].name, seed) & (HASH_SLOTS - 1)];
+                collided = slot != 0;
+                slot = static_cast<std::uint8_t>(i + 1);
+            }
+            if (!collided)
+            {
+                return table;
+            }
+        }
+        return PerfectHash{};
+    }
+
+    constexpr PerfectHash COMMAND_HASH = buildPerfectHash();
+
+    constexpr bool hashIsPerfect()
+    {
+        for (std::size_t i = 0; i < COMMAND_SPECS; ++i)
+        {
+            if (COMMAND_HASH.slots[hashName(COMMANDS[i].name, COMMAND_HASH.seed) & (HASH_SLOTS - 1)] != i + 1)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(hashIsPerfect(), "no collision-free seed found for the command table");
+}
+
+const CommandSpec *commandSpecs()
+{
+    return COMMANDS;
+}
+
+std::size_t commandSpecCount()
+{
+    return COMMAND_SPECS;
+}
+
+std::optional<CommandId> findCommand(std::string_view line)
+{
+    std::uint8_t slot = COMMAND_HASH.slots[hashName(line, COMMAND_HASH.seed) & (HASH_SLOTS - 1)];
+    if (slot == 0 || COMMANDS[slot - 1].name != line)
+    {
+        return std::nullopt;
+    }
+    return COMMANDS[slot - 1].id;
+}
+
+std::optional<int> parseChoice(std::string_view line)
+{
+    // from_chars would also accept a leading minus sign
+    if (line.empty() || line.front() < '0' || line.front() > '9')
+    {
+        return std::nullopt;
+    }
+
+    int value = 0;
+    auto result = std::from_chars(line.data(), line.data() + line.size(), value);
+    if (result.ec != std::errc() || result.ptr != line.data() + line.size())
+    {
+        return std::nullopt;
+    }
+    return value;
+}
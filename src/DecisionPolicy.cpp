@@ -0,0 +1,145 @@
+#include "DecisionPolicy.h"
+#include "Game.h"
+
+namespace
+{
+    bool hasBoost(const Player &player)
+    {
+        return player.getItemCount(ATTACK_BOOST) > 0 || player.getItemCount(DEFENSE_BOOST) > 0;
+    }
+}
+
+int GreedyPolicy::choose(const Game &game, ChoicePrompt prompt)
+{
+    switch (prompt)
+    {
+    case ChoicePrompt::MAIN_MENU:
+        return 1; // Start New Game
+    case ChoicePrompt::EXPLORING:
+        return chooseExploring(game);
+    case ChoicePrompt::COMBAT:
+        return chooseCombat(game);
+    case ChoicePrompt::SHOP:
+        return chooseShop(game);
+    case ChoicePrompt::TALKING_TO_NPC:
+        return chooseNPC(game);
+    case ChoicePrompt::USE_ITEM:
+        return chooseItem(game);
+    }
+    return 0;
+}
+
+int GreedyPolicy::chooseExploring(const Game &game) const
+{
+    const Player &player = game.getPlayer();
+
+    if (hasBoost(player))
+    {
+        return 5; // Use item
+    }
+    if (player.getHealth() * 10 < player.getMaxHealth() * 6)
+    {
+        return 3; // Rest
+    }
+    if (wantsToShop(game))
+    {
+        return 2; // Talk to Nick
+    }
+    return 1; // Look for enemies
+}
+
+int GreedyPolicy::chooseCombat(const Game &game) const
+{
+    const Player &player = game.getPlayer();
+    const Enemy *enemy = game.getCurrentEnemy();
+
+    bool lowHealth = player.getHealth() * 100 < player.getMaxHealth() * 35;
+    if (lowHealth && player.getItemCount(HEALTH_POTION) > 0)
+    {
+        return 3; // Use item
+    }
+    if (lowHealth && enemy && !enemy->getIsBoss() && player.getHealth() <= enemy->getAttack() + 2)
+    {
+        return 5; // Run away
+    }
+    return 1; // Attack
+}
+
+int GreedyPolicy::chooseShop(const Game &game) const
+{
+    const Player &player = game.getPlayer();
+    const NPC *shopkeeper = game.getShopkeeper();
+    if (!shopkeeper)
+    {
+        return 0;
+    }
+
+    const ShopCatalog &shop = shopkeeper->getShop();
+    int exitChoice = static_cast<int>(shop.size()) + 2;
+    if (!wantsToShop(game))
+    {
+        return exitChoice;
+    }
+
+    // Potions first, then permanent boosts
+    bool needPotions = player.getItemCount(HEALTH_POTION) < 2;
+    int index = 1;
+    int boostChoice = 0;
+    for (const ShopEntry &entry : shop)
+    {
+        if (entry.price <= player.getBDP())
+        {
+            if (entry.item == HEALTH_POTION && needPotions)
+            {
+                return index;
+            }
+            if (entry.item != HEALTH_POTION && boostChoice == 0)
+            {
+                boostChoice = index;
+            }
+        }
+        index++;
+    }
+    return boostChoice ? boostChoice : exitChoice;
+}
+
+int GreedyPolicy::chooseNPC(const Game &game) const
+{
+    return wantsToShop(game) ? 2 : 4; // Shop or leave
+}
+
+int GreedyPolicy::chooseItem(const Game &game) const
+{
+    const Player &player = game.getPlayer();
+
+    if (player.getHealth() * 2 < player.getMaxHealth())
+    {
+        if (int slot = player.getItemSlot(HEALTH_POTION))
+        {
+            return slot;
+        }
+    }
+    if (int slot = player.getItemSlot(ATTACK_BOOST))
+    {
+        return slot;
+    }
+    if (int slot = player.getItemSlot(DEFENSE_BOOST))
+    {
+        return slot;
+    }
+    return player.getItemSlot(HEALTH_POTION);
+}
+
+bool GreedyPolicy::wantsToShop(const Game &game) const
+{
+    const Player &player = game.getPlayer();
+    if (!game.getShopkeeper())
+    {
+        return false;
+    }
+    if (player.getItemCount(HEALTH_POTION) < 2 && player.getBDP() >= 20)
+    {
+        return true;
+    }
+    return player.getBDP() >= 50;
+}
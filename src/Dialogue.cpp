@@ -0,0 +1,284 @@
+#include "Dialogue.h"
+#include "Snapshot.h"
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<DialogueHeader> && sizeof(DialogueHeader) % 8 == 0 &&
+                  sizeof(DialoguePoolRecord) % 8 == 0 && sizeof(DialogueLineRecord) % 8 == 0,
+              "corpus sections must stay 8-byte aligned plain data");
+
+// content/dialogue.txt, embedded by CMake (src/DialogueBuiltIn.cpp.in)
+extern const std::string_view BUILT_IN_DIALOGUE_SOURCE;
+
+namespace
+{
+    // A corpus checked and ready to read; all null when there is none
+    struct MappedCorpus
+    {
+        std::unique_ptr<MappedFile> file; // Null for the built-in corpus
+        const DialogueHeader *header = nullptr;
+        const DialoguePoolRecord *pools = nullptr;
+        const DialogueLineRecord *lines = nullptr;
+        const char *text = nullptr;
+    };
+
+    MappedCorpus active; // A loaded file; the built-in corpus is used while it is empty
+
+    bool inText(const DialogueHeader &header, std::uint32_t offset, std::uint32_t length)
+    {
+        return offset <= header.textBytes && length <= header.textBytes - offset;
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        std::size_t start = text.find_first_not_of(" \t\r");
+        if (start == std::string_view::npos)
+        {
+            return {};
+        }
+        std::size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(start, end - start + 1);
+    }
+
+    template <typename T>
+    void put(std::vector<char> &buffer, std::size_t offset, const T &record)
+    {
+        std::memcpy(buffer.data() + offset, &record, sizeof(T));
+    }
+
+    // Checks the header and pools of a corpus in memory and points corpus at its sections
+    bool attach(const char *data, std::size_t size, const std::string &name, MappedCorpus &corpus, std::string &error)
+    {
+        const auto *header = reinterpret_cast<const DialogueHeader *>(data);
+        if (size < sizeof(DialogueHeader) || header->magic != DIALOGUE_MAGIC ||
+            header->version != DIALOGUE_VERSION || header->headerSize != sizeof(DialogueHeader) ||
+            header->totalSize > size)
+        {
+            error = name + ": not a dialogue corpus (compile one with dialogue_compiler)";
+            return false;
+        }
+
+        // Counts are 32-bit, so this sum cannot overflow 64 bits
+        std::uint64_t textStart = sizeof(DialogueHeader) +
+                                  std::uint64_t(header->poolCount) * sizeof(DialoguePoolRecord) +
+                                  std::uint64_t(header->lineCount) * sizeof(DialogueLineRecord);
+        if (textStart + header->textBytes > header->totalSize)
+        {
+            error = name + ": truncated corpus";
+            return false;
+        }
+
+        const auto *pools = reinterpret_cast<const DialoguePoolRecord *>(data + sizeof(DialogueHeader));
+        for (std::uint32_t i = 0; i < header->poolCount; ++i)
+        {
+            const DialoguePoolRecord &pool = pools[i];
+            if (!inText(*header, pool.nameOffset, pool.nameLength) ||
+                std::uint64_t(pool.firstLine) + pool.lineCount > header->lineCount)
+            {
+                error = name + ": pool " + std::to_string(i) + " is out of range";
+                return false;
+            }
+        }
+
+        corpus.header = header;
+        corpus.pools = pools;
+        corpus.lines = reinterpret_cast<const DialogueLineRecord *>(pools + header->poolCount);
+        corpus.text = data + textStart;
+        return true;
+    }
+
+    // Compiled from the embedded source the first time it is needed. The
+    // build compiles the same file with dialogue_compiler, so a bad source
+    // fails there; here it would only leave the corpus empty.
+    const MappedCorpus &builtIn()
+    {
+        static std::vector<char> bytes;
+        static const MappedCorpus corpus = []
+        {
+            MappedCorpus compiled;
+            std::string error;
+            if (DialogueCorpus::compile(BUILT_IN_DIALOGUE_SOURCE, bytes, error))
+            {
+                attach(bytes.data(), bytes.size(), "built-in dialogue", compiled, error);
+            }
+            return compiled;
+        }();
+        return corpus;
+    }
+
+    const MappedCorpus &current()
+    {
+        return active.header ? active : builtIn();
+    }
+}
+
+DialogueRange DialogueCorpus::find(std::string_view pool)
+{
+    const MappedCorpus &corpus = current();
+    if (!corpus.header)
+    {
+        return {};
+    }
+    for (std::uint32_t i = 0; i < corpus.header->poolCount; ++i)
+    {
+        const DialoguePoolRecord &record = corpus.pools[i];
+        if (std::string_view(corpus.text + record.nameOffset, record.nameLength) == pool)
+        {
+            return {record.firstLine, record.lineCount};
+        }
+    }
+    return {};
+}
+
+std::string_view DialogueCorpus::line(std::uint32_t index)
+{
+    const MappedCorpus &corpus = current();
+    if (!corpus.header || index >= corpus.header->lineCount)
+    {
+        return "...";
+    }
+    const DialogueLineRecord &record = corpus.lines[index];
+    if (!inText(*corpus.header, record.offset, record.length))
+    {
+        return "...";
+    }
+    return std::string_view(corpus.text + record.offset, record.length);
+}
+
+std::size_t DialogueCorpus::lineCount()
+{
+    const MappedCorpus &corpus = current();
+    return corpus.header ? corpus.header->lineCount : 0;
+}
+
+bool DialogueCorpus::loadFile(const std::string &path, std::string &error)
+{
+    auto file = std::make_unique<MappedFile>(path);
+    if (!file->isOpen())
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    MappedCorpus corpus;
+    if (!attach(file->getData(), file->getSize(), path, corpus, error))
+    {
+        return false;
+    }
+    corpus.file = std::move(file);
+    active = std::move(corpus);
+    return true;
+}
+
+void DialogueCorpus::useBuiltIn()
+{
+    active = MappedCorpus();
+}
+
+bool DialogueCorpus::compile(std::string_view source, std::vector<char> &corpus, std::string &error)
+{
+    struct Pool
+    {
+        std::string_view name;
+        std::uint32_t firstLine;
+        std::uint32_t lineCount;
+    };
+    std::vector<Pool> pools;
+    std::vector<std::string_view> lines;
+
+    int lineNumber = 0;
+    while (!source.empty())
+    {
+        lineNumber++;
+        std::size_t end = source.find('\n');
+        std::string_view text = trim(source.substr(0, end));
+        source.remove_prefix(end == std::string_view::npos ? source.size() : end + 1);
+
+        if (text.empty() || text.front() == '#')
+        {
+            continue;
+        }
+
+        std::string problem;
+        if (text.front() == '[')
+        {
+            std::string_view name = text.back() == ']' ? trim(text.substr(1, text.size() - 2)) : std::string_view();
+            if (name.empty())
+            {
+                problem = "expected [pool name]";
+            }
+            for (const Pool &pool : pools)
+            {
+                if (pool.name == name)
+                {
+                    problem = "duplicate pool " + std::string(name);
+                }
+            }
+            pools.push_back({name, static_cast<std::uint32_t>(lines.size()), 0});
+        }
+        else if (pools.empty())
+        {
+            problem = "dialogue before the first [pool]";
+        }
+        else
+        {
+            lines.push_back(text);
+            pools.back().lineCount++;
+        }
+
+        if (!problem.empty())
+        {
+            error = "line " + std::to_string(lineNumber) + ": " + problem;
+            return false;
+        }
+    }
+
+    std::size_t textStart = sizeof(DialogueHeader) + pools.size() * sizeof(DialoguePoolRecord) +
+                            lines.size() * sizeof(DialogueLineRecord);
+    std::size_t textBytes = 0;
+    for (const Pool &pool : pools)
+    {
+        textBytes += pool.name.size();
+    }
+    for (std::string_view text : lines)
+    {
+        textBytes += text.size();
+    }
+    if (textStart + textBytes > UINT32_MAX)
+    {
+        error = "corpus is larger than 4 GB";
+        return false;
+    }
+
+    // Pad so the corpus can be concatenated or mapped back to back, like a snapshot
+    std::size_t totalSize = (textStart + textBytes + 7) & ~std::size_t(7);
+    corpus.assign(totalSize, 0);
+
+    DialogueHeader header{DIALOGUE_MAGIC, DIALOGUE_VERSION, sizeof(DialogueHeader),
+                          static_cast<std::uint32_t>(totalSize), static_cast<std::uint32_t>(pools.size()),
+                          static_cast<std::uint32_t>(lines.size()), static_cast<std::uint32_t>(textBytes)};
+    put(corpus, 0, header);
+
+    std::uint32_t textOffset = 0;
+    auto addText = [&](std::string_view text)
+    {
+        std::memcpy(corpus.data() + textStart + textOffset, text.data(), text.size());
+        textOffset += static_cast<std::uint32_t>(text.size());
+        return textOffset - static_cast<std::uint32_t>(text.size());
+    };
+    for (std::size_t i = 0; i < pools.size(); ++i)
+    {
+        DialoguePoolRecord record{0, static_cast<std::uint32_t>(pools[i].name.size()), pools[i].firstLine, pools[i].lineCount};
+        record.nameOffset = addText(pools[i].name);
+        put(corpus, sizeof(DialogueHeader) + i * sizeof(DialoguePoolRecord), record);
+    }
+    std::size_t linesStart = sizeof(DialogueHeader) + pools.size() * sizeof(DialoguePoolRecord);
+    for (std::size_t i = 0; i < lines.size(); ++i)
+    {
+        DialogueLineRecord record{0, static_cast<std::uint32_t>(lines[i].size())};
+        record.offset = addText(lines[i]);
+        put(corpus, linesStart + i * sizeof(DialogueLineRecord), record);
+    }
+    return true;
+}
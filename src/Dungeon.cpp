@@ -0,0 +1,278 @@
+#include "Dungeon.h"
+#include "Random.h"
+#include <algorithm>
+
+namespace
+{
+    // Separate stream families, so rooms, doorways and encounters never share draws
+    const std::uint64_t ROOM_SALT = 0x526f6f6d73ULL;
+    const std::uint64_t EAST_EDGE_SALT = 0x4561737445ULL;
+    const std::uint64_t SOUTH_EDGE_SALT = 0x536f757468ULL;
+    const std::uint64_t ENCOUNTER_SALT = 0x456e636f756eULL;
+
+    // Room interiors keep two tiles clear of the chunk border for doorway corridors
+    const int ROOM_MARGIN = 2;
+    const int ROOM_ATTEMPTS = 16;
+    // Endless levels scatter encounters over the chunks this close to the start
+    const int ENDLESS_ENCOUNTER_RADIUS = 2;
+
+    std::uint64_t streamKey(std::uint64_t seed, int level, std::int64_t a, std::int64_t b, std::uint64_t salt)
+    {
+        std::uint64_t key = RandomStream::mix(seed ^ salt);
+        key = RandomStream::mix(key ^ static_cast<std::uint32_t>(level));
+        return RandomStream::mix(key ^ (static_cast<std::uint64_t>(static_cast<std::uint32_t>(a)) << 32 |
+                                        static_cast<std::uint32_t>(b)));
+    }
+
+    // Where the doorway sits on the east or south edge of chunk (x, y); the
+    // chunk on the other side asks for the same edge and gets the same answer
+    int doorwayOffset(std::uint64_t seed, int level, int x, int y, std::uint64_t edgeSalt)
+    {
+        RandomStream rng(streamKey(seed, level, x, y, edgeSalt));
+        return rng.uniformInt(ROOM_MARGIN, CHUNK_SIZE - 1 - ROOM_MARGIN);
+    }
+
+    bool overlaps(const DungeonRoom &a, const DungeonRoom &b)
+    {
+        // One tile of wall must separate rooms
+        return a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height;
+    }
+
+    void carve(DungeonChunk &chunk, int x, int y)
+    {
+        Tile &tile = chunk.tiles[y * CHUNK_SIZE + x];
+        if (tile == Tile::WALL)
+        {
+            tile = Tile::CORRIDOR;
+        }
+    }
+
+    // Straight run between two local tiles on the same row or column
+    void carveRun(DungeonChunk &chunk, TilePos a, TilePos b)
+    {
+        for (int x = std::min(a.x, b.x); x <= std::max(a.x, b.x); ++x)
+        {
+            for (int y = std::min(a.y, b.y); y <= std::max(a.y, b.y); ++y)
+            {
+                carve(chunk, x, y);
+            }
+        }
+    }
+
+    // L-shaped corridor between two local tiles
+    void carveCorridor(DungeonChunk &chunk, TilePos from, TilePos to, bool horizontalFirst)
+    {
+        TilePos corner = horizontalFirst ? TilePos{to.x, from.y} : TilePos{from.x, to.y};
+        carveRun(chunk, from, corner);
+        carveRun(chunk, corner, to);
+    }
+}
+
+ChunkCoord ChunkCoord::of(TilePos tile)
+{
+    // Floor division, so negative tiles land in negative chunks
+    auto floorDiv = [](std::int32_t value)
+    { return value >= 0 ? value / CHUNK_SIZE : (value + 1) / CHUNK_SIZE - 1; };
+    return {floorDiv(tile.x), floorDiv(tile.y)};
+}
+
+DungeonMap::DungeonMap(std::size_t cachedChunks)
+    : capacity(std::max<std::size_t>(cachedChunks, 1)) {}
+
+void DungeonMap::reset(std::uint64_t newSeed, int newLevel, int newExtent)
+{
+    seed = newSeed;
+    level = newLevel;
+    extent = std::max(newExtent, 0);
+    for (Slot &slot : slots)
+    {
+        slot.lastUse = 0;
+    }
+    lastHit = 0;
+}
+
+bool DungeonMap::contains(ChunkCoord coord) const
+{
+    return extent == 0 || (coord.x >= 0 && coord.y >= 0 && coord.x < extent && coord.y < extent);
+}
+
+DungeonMap::Slot &DungeonMap::slotFor(ChunkCoord coord)
+{
+    useClock++;
+    if (lastHit < slots.size() && slots[lastHit].lastUse != 0 && slots[lastHit].chunk.coord == coord)
+    {
+        slots[lastHit].lastUse = useClock;
+        return slots[lastHit];
+    }
+
+    // Find the chunk, or failing that an empty slot, or the least recently used one
+    std::size_t victim = slots.size();
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+        if (slots[i].lastUse != 0 && slots[i].chunk.coord == coord)
+        {
+            lastHit = i;
+            slots[i].lastUse = useClock;
+            return slots[i];
+        }
+        if (victim == slots.size() || slots[i].lastUse < slots[victim].lastUse)
+        {
+            victim = i;
+        }
+    }
+    if (slots.size() < capacity && (victim == slots.size() || slots[victim].lastUse != 0))
+    {
+        victim = slots.size();
+        slots.emplace_back();
+    }
+
+    generateChunk(seed, level, extent, coord, slots[victim].chunk);
+    chunksGenerated++;
+    slots[victim].lastUse = useClock;
+    lastHit = victim;
+    return slots[victim];
+}
+
+const DungeonChunk &DungeonMap::chunk(ChunkCoord coord)
+{
+    return slotFor(coord).chunk;
+}
+
+Tile DungeonMap::tileAt(TilePos tile)
+{
+    ChunkCoord coord = ChunkCoord::of(tile);
+    if (!contains(coord))
+    {
+        return Tile::WALL;
+    }
+    return slotFor(coord).chunk.at(tile.x - coord.x * CHUNK_SIZE, tile.y - coord.y * CHUNK_SIZE);
+}
+
+void DungeonMap::prefetch(TilePos tile, int radius)
+{
+    ChunkCoord center = ChunkCoord::of(tile);
+    for (int dy = -radius; dy <= radius; ++dy)
+    {
+        for (int dx = -radius; dx <= radius; ++dx)
+        {
+            ChunkCoord coord{center.x + dx, center.y + dy};
+            if (contains(coord))
+            {
+                slotFor(coord);
+            }
+        }
+    }
+}
+
+std::size_t DungeonMap::cachedChunks() const
+{
+    return static_cast<std::size_t>(std::count_if(slots.begin(), slots.end(), [](const Slot &slot)
+                                                  { return slot.lastUse != 0; }));
+}
+
+TilePos DungeonMap::startPosition() const
+{
+    return layoutRooms(seed, level, extent, {0, 0}).rooms[0].center();
+}
+
+TilePos DungeonMap::encounterPosition(std::size_t index) const
+{
+    RandomStream rng(streamKey(seed, level, static_cast<std::int64_t>(index), 0, ENCOUNTER_SALT));
+    int low = extent == 0 ? -ENDLESS_ENCOUNTER_RADIUS : 0;
+    int high = extent == 0 ? ENDLESS_ENCOUNTER_RADIUS : extent - 1;
+
+    // Redraw while the chunk offers nothing but the start room; a one-chunk
+    // level with a single room settles for the start room
+    for (int attempt = 0;; ++attempt)
+    {
+        ChunkCoord coord{rng.uniformInt(low, high), rng.uniformInt(low, high)};
+        ChunkRooms layout = layoutRooms(seed, level, extent, coord);
+        int first = coord == ChunkCoord{0, 0} && (layout.count > 1 || attempt < 8) ? 1 : 0;
+        if (first >= layout.count)
+        {
+            continue;
+        }
+        const DungeonRoom &room = layout.rooms[rng.uniformInt(first, layout.count - 1)];
+        return {coord.x * CHUNK_SIZE + room.x + rng.uniformInt(1, room.width - 2),
+                coord.y * CHUNK_SIZE + room.y + rng.uniformInt(1, room.height - 2)};
+    }
+}
+
+ChunkRooms DungeonMap::layoutRooms(std::uint64_t seed, int level, int extent, ChunkCoord coord)
+{
+    ChunkRooms layout;
+    if (extent != 0 && (coord.x < 0 || coord.y < 0 || coord.x >= extent || coord.y >= extent))
+    {
+        return layout;
+    }
+
+    RandomStream rng(streamKey(seed, level, coord.x, coord.y, ROOM_SALT));
+    int wanted = rng.uniformInt(2, MAX_CHUNK_ROOMS);
+    for (int attempt = 0; attempt < ROOM_ATTEMPTS && layout.count < wanted; ++attempt)
+    {
+        int width = rng.uniformInt(4, 9);
+        int height = rng.uniformInt(4, 8);
+        DungeonRoom room{static_cast<std::int8_t>(rng.uniformInt(ROOM_MARGIN, CHUNK_SIZE - ROOM_MARGIN - width)),
+                         static_cast<std::int8_t>(rng.uniformInt(ROOM_MARGIN, CHUNK_SIZE - ROOM_MARGIN - height)),
+                         static_cast<std::int8_t>(width), static_cast<std::int8_t>(height)};
+        bool clear = std::none_of(layout.rooms.begin(), layout.rooms.begin() + layout.count,
+                                  [&](const DungeonRoom &other)
+                                  { return overlaps(room, other); });
+        if (clear)
+        {
+            layout.rooms[layout.count++] = room;
+        }
+    }
+    return layout;
+}
+
+void DungeonMap::generateChunk(std::uint64_t seed, int level, int extent, ChunkCoord coord, DungeonChunk &chunk)
+{
+    chunk.coord = coord;
+    chunk.layout = layoutRooms(seed, level, extent, coord);
+    chunk.tiles.fill(Tile::WALL);
+    if (chunk.layout.count == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < chunk.layout.count; ++i)
+    {
+        const DungeonRoom &room = chunk.layout.rooms[i];
+        for (int y = room.y; y < room.y + room.height; ++y)
+        {
+            std::fill_n(chunk.tiles.begin() + y * CHUNK_SIZE + room.x, room.width, Tile::FLOOR);
+        }
+    }
+
+    // Chain the rooms in order, alternating the corridor's bend
+    for (int i = 1; i < chunk.layout.count; ++i)
+    {
+        carveCorridor(chunk, chunk.layout.rooms[i - 1].center(), chunk.layout.rooms[i].center(), i % 2 == 1);
+    }
+
+    // Doorways to the neighbouring chunks, all joined to the first room
+    auto inside = [&](int dx, int dy)
+    {
+        ChunkCoord next{coord.x + dx, coord.y + dy};
+        return extent == 0 || (next.x >= 0 && next.y >= 0 && next.x < extent && next.y < extent);
+    };
+    TilePos hub = chunk.layout.rooms[0].center();
+    const int last = CHUNK_SIZE - 1;
+    if (inside(1, 0))
+    {
+        carveCorridor(chunk, {last, doorwayOffset(seed, level, coord.x, coord.y, EAST_EDGE_SALT)}, hub, true);
+    }
+    if (inside(-1, 0))
+    {
+        carveCorridor(chunk, {0, doorwayOffset(seed, level, coord.x - 1, coord.y, EAST_EDGE_SALT)}, hub, true);
+    }
+    if (inside(0, 1))
+    {
+        carveCorridor(chunk, {doorwayOffset(seed, level, coord.x, coord.y, SOUTH_EDGE_SALT), last}, hub, false);
+    }
+    if (inside(0, -1))
+    {
+        carveCorridor(chunk, {doorwayOffset(seed, level, coord.x, coord.y - 1, SOUTH_EDGE_SALT), 0}, hub, false);
+    }
+}
@@ -1,54 +1,136 @@
 #include "Enemy.h"
-#include <iostream>
+#include "Balance.h"
+#include <type_traits>
 
-Enemy::Enemy(const std::string &name, int health, int attack, int defense,
-             int experienceReward, int bdpReward, bool isBoss, const std::string &emoji)
-    : Entity(name, health, attack, defense),
-      experienceReward(experienceReward),
-      bdpReward(bdpReward),
-      isBoss(isBoss),
-      emoji(emoji) {}
+static_assert(std::is_trivially_copyable_v<Enemy> && sizeof(Enemy) == 8, "enemies must stay small plain records");
+
+Enemy::Enemy(EnemyArchetypeId archetype, int level)
+    : archetype(archetype),
+      level(static_cast<std::uint16_t>(level)),
+      health(0)
+{
+    health = getMaxHealth();
+}
+
+const EnemyArchetype &Enemy::getArchetype() const
+{
+    return EnemyRegistry::get(archetype);
+}
+
+EnemyArchetypeId Enemy::getArchetypeId() const
+{
+    return archetype;
+}
+
+int Enemy::getLevel() const
+{
+    return level;
+}
+
+std::string_view Enemy::getName() const
+{
+    return getArchetype().name;
+}
+
+std::string_view Enemy::getEmoji() const
+{
+    return getArchetype().emoji;
+}
+
+int Enemy::getHealth() const
+{
+    return health;
+}
+
+// Archetype stats scaled by the balance percentages (Balance.h)
+int Enemy::getMaxHealth() const
+{
+    const EnemyArchetype &type = getArchetype();
+    const BalanceParams &balance = Balance::get();
+    return Balance::scale(type.health.at(level), type.isBoss ? balance.bossHealthPercent : balance.enemyHealthPercent);
+}
+
+int Enemy::getAttack() const
+{
+    const EnemyArchetype &type = getArchetype();
+    const BalanceParams &balance = Balance::get();
+    return Balance::scale(type.attack.at(level), type.isBoss ? balance.bossAttackPercent : balance.enemyAttackPercent);
+}
+
+int Enemy::getDefense() const
+{
+    const EnemyArchetype &type = getArchetype();
+    const BalanceParams &balance = Balance::get();
+    return Balance::scale(type.defense.at(level), type.isBoss ? balance.bossDefensePercent : balance.enemyDefensePercent);
+}
 
 int Enemy::getExperienceReward() const
 {
-    return experienceReward;
+    return getArchetype().experienceReward.at(level);
 }
 
 int Enemy::getBDPReward() const
 {
-    return bdpReward;
+    return getArchetype().bdpReward.at(level);
 }
 
 bool Enemy::getIsBoss() const
 {
-    return isBoss;
+    return getArchetype().isBoss;
 }
 
-std::string Enemy::getEmoji() const
+void Enemy::setHealth(int newHealth)
 {
-    return emoji;
+    int maxHealth = getMaxHealth();
+    health = (newHealth > maxHealth) ? maxHealth : newHealth;
 }
 
-void Enemy::displayStats() const
+int Enemy::takeDamage(int damage, GameOutput &out)
 {
-    if (isBoss)
+    int actualDamage = damage - getDefense();
+    if (actualDamage < 1)
+        actualDamage = 1; // Minimum damage is 1
+
+    health -= actualDamage;
+    if (health < 0)
+        health = 0;
+
+    out << getName() << " takes " << actualDamage << " damage! 💥\n";
+    return actualDamage;
+}
+
+int Enemy::calculateDamage(RandomStream &rng) const
+{
+    int damage = getAttack() + rng.uniformInt(-2, 2); // Random modifier between -2 and +2
+    return (damage < 1) ? 1 : damage; // Minimum damage is 1
+}
+
+bool Enemy::isAlive() const
+{
+    return health > 0;
+}
+
+void Enemy::displayStats(GameOutput &out) const
+{
+    const EnemyArchetype &type = getArchetype();
+    if (type.isBoss)
     {
-        std::cout << "\n🔥🔥🔥 BOSS 🔥🔥🔥" << std::endl;
+        out << "\n🔥🔥🔥 BOSS 🔥🔥🔥\n";
     }
 
-    std::cout << emoji << " " << name;
-    if (isBoss)
+    out << type.emoji << " " << type.name;
+    if (type.isBoss)
     {
-        std::cout << " 👑";
+        out << " 👑";
     }
-    std::cout << std::endl;
+    out << '\n';
 
-    std::cout << "❤️ Health: " << health << "/" << maxHealth << std::endl;
-    std::cout << "⚔️ Attack: " << attack << std::endl;
-    std::cout << "🛡️ Defense: " << defense << std::endl;
+    out << "❤️ Health: " << health << "/" << getMaxHealth() << '\n';
+    out << "⚔️ Attack: " << getAttack() << '\n';
+    out << "🛡️ Defense: " << getDefense() << '\n';
 
-    if (isBoss)
+    if (type.isBoss)
     {
-        std::cout << "💀 DANGER LEVEL: EXTREME 💀" << std::endl;
+        out << "💀 DANGER LEVEL: EXTREME 💀\n";
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,260 @@
+#include "EnemyArchetype.h"
+#include <charconv>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr EnemyArchetype BUILT_IN_ARCHETYPES[] = {
+        //  name        emoji  health    attack   defense  xp       bdp
+        {"Goblin", "👺", {20, 5}, {5, 2}, {2, 1}, {15, 5}, {5, 2}, false},
+        {"Skeleton", "💀", {15, 4}, {7, 2}, {1, 1}, {20, 5}, {7, 2}, false},
+        {"Slime", "🟢", {25, 6}, {4, 1}, {3, 1}, {10, 4}, {3, 2}, false},
+        {"Bat", "🦇", {10, 3}, {6, 2}, {1, 1}, {12, 4}, {4, 2}, false},
+        {"NICK", "😈", {200, 0}, {25, 0}, {15, 0}, {500, 0}, {1000, 0}, true},
+    };
+
+    constexpr bool hasArchetype(bool boss)
+    {
+        for (const EnemyArchetype &type : BUILT_IN_ARCHETYPES)
+        {
+            if (type.isBoss == boss)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    static_assert(hasArchetype(false) && hasArchetype(true), "the game needs regular enemies and a boss to win against");
+    static_assert(sizeof(BUILT_IN_ARCHETYPES) / sizeof(BUILT_IN_ARCHETYPES[0]) <= MAX_ENEMY_ARCHETYPES,
+                  "archetype IDs are one byte");
+
+    struct ArchetypeTable
+    {
+        std::vector<EnemyArchetype> types;
+        std::vector<EnemyArchetypeId> regular;
+        std::vector<EnemyArchetypeId> bosses;
+        std::deque<std::string> text; // Names and emoji of a loaded table; a deque never moves them
+
+        void add(const EnemyArchetype &type)
+        {
+            EnemyArchetypeId id = static_cast<EnemyArchetypeId>(types.size());
+            types.push_back(type);
+            (type.isBoss ? bosses : regular).push_back(id);
+        }
+    };
+
+    ArchetypeTable makeBuiltIn()
+    {
+        ArchetypeTable table;
+        for (const EnemyArchetype &type : BUILT_IN_ARCHETYPES)
+        {
+            table.add(type);
+        }
+        return table;
+    }
+
+    const ArchetypeTable builtIn = makeBuiltIn();
+    std::unique_ptr<ArchetypeTable> loaded;
+    const ArchetypeTable *active = &builtIn;
+
+    // Splits off the next whitespace-separated word
+    std::string_view nextWord(std::string_view &line)
+    {
+        std::size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string_view::npos)
+        {
+            line = {};
+            return {};
+        }
+        std::size_t end = line.find_first_of(" \t\r", start);
+        if (end == std::string_view::npos)
+        {
+            end = line.size();
+        }
+        std::string_view word = line.substr(start, end - start);
+        line.remove_prefix(end);
+        return word;
+    }
+
+    // "base" or "base+perLevel" / "base-perLevel"
+    bool parseScaling(std::string_view word, StatScaling &scaling)
+    {
+        const char *end = word.data() + word.size();
+        auto [next, error] = std::from_chars(word.data(), end, scaling.base);
+        if (error != std::errc())
+        {
+            return false;
+        }
+        scaling.perLevel = 0;
+        if (next == end)
+        {
+            return true;
+        }
+        if (*next == '+')
+        {
+            ++next;
+        }
+        else if (*next != '-')
+        {
+            return false;
+        }
+        auto [last, perLevelError] = std::from_chars(next, end, scaling.perLevel);
+        return perLevelError == std::errc() && last == end;
+    }
+
+    bool parseLine(std::string_view line, ArchetypeTable &table, std::string &problem)
+    {
+        std::string_view name = nextWord(line);
+        std::string_view emoji = nextWord(line);
+        StatScaling *stats[5];
+        EnemyArchetype type{};
+        stats[0] = &type.health;
+        stats[1] = &type.attack;
+        stats[2] = &type.defense;
+        stats[3] = &type.experienceReward;
+        stats[4] = &type.bdpReward;
+
+        if (emoji.empty())
+        {
+            problem = "expected <name> <emoji> <health> <attack> <defense> <xp> <bdp> [boss]";
+            return false;
+        }
+        for (StatScaling *stat : stats)
+        {
+            if (!parseScaling(nextWord(line), *stat))
+            {
+                problem = "stats must be numbers like 20 or 20+5";
+                return false;
+            }
+        }
+
+        std::string_view flag = nextWord(line);
+        type.isBoss = flag == "boss";
+        if ((!flag.empty() && !type.isBoss) || !nextWord(line).empty())
+        {
+            problem = "unexpected text after the stats";
+            return false;
+        }
+        if (type.health.at(1) <= 0 || type.health.perLevel < 0)
+        {
+            problem = "health must be positive and must not fall with the level";
+            return false;
+        }
+        for (const EnemyArchetype &existing : table.types)
+        {
+            if (existing.name == name)
+            {
+                problem = "duplicate enemy type";
+                return false;
+            }
+        }
+        if (table.types.size() == MAX_ENEMY_ARCHETYPES)
+        {
+            problem = "too many enemy types";
+            return false;
+        }
+
+        type.name = table.text.emplace_back(name);
+        type.emoji = table.text.emplace_back(emoji);
+        table.add(type);
+        return true;
+    }
+}
+
+std::size_t EnemyRegistry::size()
+{
+    return active->types.size();
+}
+
+bool EnemyRegistry::isValid(EnemyArchetypeId id)
+{
+    return id < active->types.size();
+}
+
+const EnemyArchetype &EnemyRegistry::get(EnemyArchetypeId id)
+{
+    return active->types[id];
+}
+
+EnemyArchetypeId EnemyRegistry::find(std::string_view name)
+{
+    for (std::size_t i = 0; i < active->types.size(); ++i)
+    {
+        if (active->types[i].name == name)
+        {
+            return static_cast<EnemyArchetypeId>(i);
+        }
+    }
+    return NO_ARCHETYPE;
+}
+
+const EnemyArchetypeId *EnemyRegistry::regular()
+{
+    return active->regular.data();
+}
+
+std::size_t EnemyRegistry::regularCount()
+{
+    return active->regular.size();
+}
+
+const EnemyArchetypeId *EnemyRegistry::bosses()
+{
+    return active->bosses.data();
+}
+
+std::size_t EnemyRegistry::bossCount()
+{
+    return active->bosses.size();
+}
+
+bool EnemyRegistry::loadFile(const std::string &path, std::string &error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    auto table = std::make_unique<ArchetypeTable>();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        std::string_view content = line;
+        content = content.substr(0, content.find('#'));
+        std::string_view rest = content;
+        if (nextWord(rest).empty())
+        {
+            continue;
+        }
+
+        std::string problem;
+        if (!parseLine(content, *table, problem))
+        {
+            error = path + ":" + std::to_string(lineNumber) + ": " + problem;
+            return false;
+        }
+    }
+
+    if (table->regular.empty() || table->bosses.empty())
+    {
+        error = path + ": needs at least one regular enemy type and one boss";
+        return false;
+    }
+
+    loaded = std::move(table);
+    active = loaded.get();
+    return true;
+}
+
+void EnemyRegistry::useBuiltIn()
+{
+    active = &builtIn;
+    loaded.reset();
+}
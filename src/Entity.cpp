@@ -1,11 +1,9 @@
 #include "Entity.h"
-#include <iostream>
-#include <random>
 
 Entity::Entity(const std::string &name, int health, int attack, int defense)
     : name(name), health(health), maxHealth(health), attack(attack), defense(defense) {}
 
-std::string Entity::getName() const
+std::string_view Entity::getName() const
 {
     return name;
 }
@@ -35,7 +33,7 @@ void Entity::setHealth(int newHealth)
     health = (newHealth > maxHealth) ? maxHealth : newHealth;
 }
 
-void Entity::takeDamage(int damage)
+int Entity::takeDamage(int damage, GameOutput &out)
 {
     int actualDamage = damage - defense;
     if (actualDamage < 1)
@@ -45,26 +43,23 @@ void Entity::takeDamage(int damage)
     if (health < 0)
         health = 0;
 
-    std::cout << name << " takes " << actualDamage << " damage! 💥" << std::endl;
+    out << name << " takes " << actualDamage << " damage! 💥\n";
+    return actualDamage;
 }
 
-void Entity::heal(int amount)
+void Entity::heal(int amount, GameOutput &out)
 {
     health += amount;
     if (health > maxHealth)
         health = maxHealth;
 
-    std::cout << name << " heals for " << amount << " health! ❤️" << std::endl;
+    out << name << " heals for " << amount << " health! ❤️\n";
 }
 
-int Entity::calculateDamage() const
+int Entity::calculateDamage(RandomStream &rng) const
 {
     // Add some randomness to damage
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distr(-2, 2); // Random modifier between -2 and +2
-
-    int damage = attack + distr(gen);
+    int damage = attack + rng.uniformInt(-2, 2); // Random modifier between -2 and +2
     return (damage < 1) ? 1 : damage; // Minimum damage is 1
 }
 
@@ -73,8 +68,8 @@ bool Entity::isAlive() const
     return health > 0;
 }
 
-void Entity::displayStats() const
+void Entity::displayStats(GameOutput &out) const
 {
-    std::cout << name << " - Health: " << health << "/" << maxHealth
-              << " | Attack: " << attack << " | Defense: " << defense << std::endl;
+    out << name << " - Health: " << health << "/" << maxHealth
+              << " | Attack: " << attack << " | Defense: " << defense << '\n';
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "FightEstimator.h"
+#include "Enemy.h"
+#include "Player.h"
+#include <algorithm>
+#include <cstdint>
+
+template <std::size_t N>
+std::size_t FightEstimator::KeyHash<N>::operator()(const std::array<int, N> &key) const
+{
+    // FNV-1a over the stats
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (int value : key)
+    {
+        hash = (hash ^ static_cast<std::uint32_t>(value)) * 0x100000001b3ull;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+const FightEstimator::HitTable &FightEstimator::hitTable(int health, int attack, int defense)
+{
+    std::array<int, 3> key{health, attack, defense};
+    auto found = hitTables.find(key);
+    if (found != hitTables.end())
+    {
+        return found->second;
+    }
+
+    // Damage per hit: the five rolls are equally likely
+    int damages[5];
+    for (int roll = -2; roll <= 2; ++roll)
+    {
+        damages[roll + 2] = std::max(1, std::max(1, attack + roll) - defense);
+    }
+
+    HitTable table;
+    table.alive.push_back(health > 0 ? 1.0 : 0.0);
+    table.remaining.push_back(health > 0 ? health : 0.0);
+
+    // taken[s] = P(damage taken so far is s and the target still stands), s < health
+    std::vector<double> taken(std::max(health, 1), 0.0);
+    std::vector<double> next(taken.size(), 0.0);
+    taken[0] = table.alive[0];
+    int lowest = 0; // Every hit deals at least 1, so states below this are empty
+
+    while (table.alive.back() > 0.0)
+    {
+        std::fill(next.begin() + lowest, next.end(), 0.0);
+        for (int s = lowest; s < health; ++s)
+        {
+            double p = taken[s] * 0.2;
+            if (p == 0.0)
+            {
+                continue;
+            }
+            for (int damage : damages)
+            {
+                if (s + damage < health)
+                {
+                    next[s + damage] += p;
+                }
+            }
+        }
+        taken.swap(next);
+        lowest++;
+
+        double alive = 0.0;
+        double remaining = 0.0;
+        for (int s = lowest; s < health; ++s)
+        {
+            alive += taken[s];
+            remaining += taken[s] * (health - s);
+        }
+        table.alive.push_back(alive);
+        table.remaining.push_back(remaining);
+    }
+
+    return hitTables.emplace(key, std::move(table)).first->second;
+}
+
+FightEstimate FightEstimator::estimate(const CombatantStats &player, const CombatantStats &enemy)
+{
+    std::array<int, 6> key{player.health, player.attack, player.defense, enemy.health, enemy.attack, enemy.defense};
+    auto found = estimates.find(key);
+    if (found != estimates.end())
+    {
+        return found->second;
+    }
+    if (estimates.size() >= MAX_CACHED_FIGHTS)
+    {
+        clear(); // Before the lookups below, which hold references into hitTables
+    }
+
+    // Enemy being hit by the player, and the player being hit by the enemy
+    const HitTable &enemySide = hitTable(enemy.health, player.attack, enemy.defense);
+    const HitTable &playerSide = hitTable(player.health, enemy.attack, player.defense);
+
+    FightEstimate result{0.0, 0.0, 0.0, 0.0};
+    for (std::size_t k = 1; k < enemySide.alive.size(); ++k)
+    {
+        // Round k: the enemy falls to the player's k-th hit, or survives it and
+        // the enemy's k-th hit fells the player
+        double enemyFallsNow = enemySide.alive[k - 1] - enemySide.alive[k];
+        double playerStanding = k - 1 < playerSide.alive.size() ? playerSide.alive[k - 1] : 0.0;
+        double playerHealth = k - 1 < playerSide.remaining.size() ? playerSide.remaining[k - 1] : 0.0;
+        double playerFallsNow = k < playerSide.alive.size() ? playerStanding - playerSide.alive[k] : playerStanding;
+
+        double win = enemyFallsNow * playerStanding;
+        double loss = enemySide.alive[k] * playerFallsNow;
+        result.winProbability += win;
+        result.expectedHealthRemaining += enemyFallsNow * playerHealth;
+        result.expectedRounds += k * (win + loss);
+    }
+    result.expectedHealthIfWon = result.winProbability > 0.0
+                                     ? result.expectedHealthRemaining / result.winProbability
+                                     : 0.0;
+
+    estimates.emplace(key, result);
+    return result;
+}
+
+FightEstimate FightEstimator::estimate(const Player &player, const Enemy &enemy)
+{
+    return estimate(CombatantStats{player.getHealth(), player.getAttack(), player.getDefense()},
+                    CombatantStats{enemy.getHealth(), enemy.getAttack(), enemy.getDefense()});
+}
+
+std::size_t FightEstimator::cachedFights() const
+{
+    return estimates.size();
+}
+
+void FightEstimator::clear()
+{
+    hitTables.clear();
+    estimates.clear();
+}
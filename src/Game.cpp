@@ -1,274 +1,535 @@
 #include "Game.h"
-#include <iostream>
+#include "Balance.h"
+#include "CombatAdvisor.h"
+#include "TerminalRenderer.h"
+#include "Replay.h"
+#include <algorithm>
 #include <string>
 #include <chrono>
 #include <thread>
-#include <random>
 #include <limits>
-#include <csignal>
+#include <cstdlib>
 
 #ifdef _WIN32
-#include <windows.h>
+#include <io.h>
 #else
 #include <cstdlib>
+#include <unistd.h>
 #endif
 
-// Global flag for signal handling
-volatile sig_atomic_t exitRequested = 0;
+// Default sink: nothing for headless games, the diffing renderer on a terminal,
+// plain buffered text when stdout is redirected
+std::unique_ptr<OutputSink> makeDefaultSink(bool headless)
+{
+    if (headless)
+    {
+        return std::make_unique<NullSink>();
+    }
+#ifdef _WIN32
+    if (_isatty(1))
+#else
+    if (isatty(STDOUT_FILENO))
+#endif
+    {
+        return std::make_unique<TerminalRenderer>();
+    }
+    return std::make_unique<TerminalSink>();
+}
 
-// Signal handler function
-void signalHandler(int signal)
+namespace
 {
-    exitRequested = 1;
-    std::cout << "\nExiting game...\n";
+    // Thrown when the session's input ends (EOF, /exit or requestExit); step() turns it into GAME_OVER
+    struct InputClosed
+    {
+    };
+
+    // Deepest level a snapshot may claim; the map grows with the level, so this bounds it
+    const int MAX_SNAPSHOT_DUNGEON_LEVEL = 100;
+
+    // Largest player health, attack or defense a snapshot may claim; the fight
+    // estimator's tables grow with health
+    const int MAX_SNAPSHOT_STAT = 10000;
+
+    // Chunks per side of a level's map
+    int levelExtent(int level)
+    {
+        return 1 + level / 3;
+    }
+
+    // The encounter field covers the chunks this close to the player's, so it
+    // stays the same small size however large the level is
+    const int ENCOUNTER_WINDOW_RADIUS = 1;
+
+    void encounterWindow(TilePos player, int extent, ChunkCoord &first, ChunkCoord &last)
+    {
+        ChunkCoord centre = ChunkCoord::of(player);
+        first = {centre.x - ENCOUNTER_WINDOW_RADIUS, centre.y - ENCOUNTER_WINDOW_RADIUS};
+        last = {centre.x + ENCOUNTER_WINDOW_RADIUS, centre.y + ENCOUNTER_WINDOW_RADIUS};
+        if (extent > 0)
+        {
+            first = {std::max(first.x, 0), std::max(first.y, 0)};
+            last = {std::min(last.x, extent - 1), std::min(last.y, extent - 1)};
+        }
+    }
 }
 
-// Helper function to get valid integer input
-int getValidIntInput()
+// Suspends the current turn until step() is called again
+struct Game::InputAwaiter
+{
+    Game &game;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> waiting) noexcept { game.waitingForInput = waiting; }
+    void await_resume() const noexcept {}
+};
+
+Task<> Game::readLine(std::string &line)
 {
-    int choice;
-    std::string input;
-    bool validInput = false;
+    out.endFrame();
 
-    while (!validInput)
+    InputStatus status;
+    metrics.beginInputWait();
+    while ((status = input->readLine(line)) == InputStatus::PENDING)
     {
-        std::getline(std::cin, input);
+        co_await InputAwaiter{*this};
+    }
+    metrics.endInputWait();
+
+    if (status == InputStatus::CLOSED || exitRequested.load(std::memory_order_relaxed))
+    {
+        out << "\nExiting game...\n";
+        throw InputClosed();
+    }
+    if (recorder)
+    {
+        recorder->recordLine(turnCount, line);
+    }
+    out.echoInput(line);
+}
 
-        // Check for EOF (Ctrl+D)
-        if (std::cin.eof())
+// Handler for each CommandId, in enum order
+const Game::CommandHandler Game::COMMAND_HANDLERS[] = {
+    &Game::showStatusCommand,
+    &Game::showInventoryCommand,
+    &Game::showHelpCommand,
+    &Game::exitCommand,
+    &Game::adviseCommand,
+    &Game::showMapCommand,
+};
+
+Task<> Game::showMapCommand()
+{
+    const int halfWidth = 30;
+    const int halfHeight = 10;
+    out << "\n--- Dungeon Level " << currentDungeonLevel << " Map ---\n";
+
+    // Rows of the view around the player; tiles outside the level stay blank
+    std::vector<std::string> rows(2 * halfHeight + 1, std::string(2 * halfWidth + 1, ' '));
+    for (int dy = -halfHeight; dy <= halfHeight; ++dy)
+    {
+        for (int dx = -halfWidth; dx <= halfWidth; ++dx)
         {
-            std::cout << "\nExiting game...\n";
-            exit(0);
+            TilePos tile{playerPosition.x + dx, playerPosition.y + dy};
+            if (dungeon.contains(ChunkCoord::of(tile)))
+            {
+                rows[dy + halfHeight][dx + halfWidth] = dungeon.isWalkable(tile) ? '.' : '#';
+            }
         }
+    }
+    for (std::size_t i = 0; i < enemies.size(); ++i)
+    {
+        TilePos tile = dungeon.encounterPosition(i);
+        int dx = tile.x - playerPosition.x;
+        int dy = tile.y - playerPosition.y;
+        if (enemies[i].isAlive() && std::abs(dx) <= halfWidth && std::abs(dy) <= halfHeight)
+        {
+            rows[dy + halfHeight][dx + halfWidth] = enemies[i].getIsBoss() ? 'B' : 'E';
+        }
+    }
+    rows[halfHeight][halfWidth] = '@';
+
+    for (const std::string &row : rows)
+    {
+        out << row << '\n';
+    }
+    out << "@ you   E enemy   B boss   # wall\n";
+    co_await waitForEnter();
+}
 
-        // Check for command inputs
-        if (input == "/status" || input == "/stats")
+void Game::showPlayerStats()
+{
+    if (!out.isEnabled())
+    {
+        return;
+    }
+    StatPanel::Values shown{player.getLevel(), player.getHealth(), player.getMaxHealth(), player.getAttack(),
+                            player.getDefense(), player.getExperience(), player.getExperienceToNextLevel(),
+                            player.getBDP()};
+    playerPanel.show(out, player.getName(), shown, [this]
+                     { player.displayStats(out); });
+}
+
+void Game::showEnemyStats(const Enemy &enemy)
+{
+    if (!out.isEnabled())
+    {
+        return;
+    }
+    // The name picks the archetype, which fixes the emoji and boss banner
+    StatPanel::Values shown{enemy.getHealth(), enemy.getMaxHealth(), enemy.getAttack(), enemy.getDefense(),
+                            enemy.getIsBoss() ? 1 : 0};
+    enemyPanel.show(out, enemy.getName(), shown, [&]
+                    { enemy.displayStats(out); });
+}
+
+Task<> Game::showStatusCommand()
+{
+    out << "\n--- Player Status ---\n";
+    showPlayerStats();
+    co_await waitForEnter();
+}
+
+Task<> Game::showInventoryCommand()
+{
+    out << "\n--- Inventory ---\n";
+    player.displayInventory(out);
+    co_await waitForEnter();
+}
+
+Task<> Game::showHelpCommand()
+{
+    out << "\n--- Available Commands ---\n";
+
+    // One line per command, listing its aliases after the main spelling
+    const CommandSpec *specs = commandSpecs();
+    for (std::size_t i = 0; i < commandSpecCount(); ++i)
+    {
+        if (specs[i].help.empty())
         {
-            std::cout << "\n--- Player Status ---\n";
-            Game::getCurrentPlayer()->displayStats();
-            std::cout << "\nPress Enter to continue...";
-            std::getline(std::cin, input);
-            std::cout << "\nEnter your choice: ";
             continue;
         }
-        else if (input == "/inventory" || input == "/inv")
+        out << specs[i].name;
+        for (std::size_t j = 0; j < commandSpecCount(); ++j)
         {
-            std::cout << "\n--- Inventory ---\n";
-            Game::getCurrentPlayer()->displayInventory();
-            std::cout << "\nPress Enter to continue...";
-            std::getline(std::cin, input);
-            std::cout << "\nEnter your choice: ";
-            continue;
+            if (j != i && specs[j].id == specs[i].id)
+            {
+                out << " or " << specs[j].name;
+            }
         }
-        else if (input == "/help")
+        out << " - " << specs[i].help << '\n';
+    }
+    co_await waitForEnter();
+}
+
+Task<> Game::exitCommand()
+{
+    out << "\nExiting game...\n";
+    throw InputClosed();
+    co_return;
+}
+
+Task<> Game::adviseCommand()
+{
+    const Enemy *enemy = currentState == GameState::COMBAT ? getCurrentEnemy() : nullptr;
+    if (!enemy)
+    {
+        out << "\nThe advisor only helps in combat.\n";
+        co_await waitForEnter();
+        co_return;
+    }
+
+    if (!advisor)
+    {
+        AdvisorConfig config;
+        config.seed = rng.getSeed();
+        if (!ownedInput)
         {
-            std::cout << "\n--- Available Commands ---\n";
-            std::cout << "/status or /stats - Display player stats\n";
-            std::cout << "/inventory or /inv - Display inventory\n";
-            std::cout << "/help - Show this help message\n";
-            std::cout << "/exit - Exit the game\n";
-            std::cout << "\nPress Enter to continue...";
-            std::getline(std::cin, input);
-            std::cout << "\nEnter your choice: ";
-            continue;
+            // Not on the console: hosted sessions share the host's workers, so the search stays on this one
+            config.threads = 1;
         }
-        else if (input == "/exit")
+        advisor = std::make_unique<CombatAdvisor>(config);
+    }
+    CombatAdvice advice = advisor->advise(player, *enemy);
+
+    out << "\n--- Advisor (" << advice.rollouts << " simulated fights) ---\n";
+    for (std::size_t i = 0; i < advice.moveCount; ++i)
+    {
+        const CombatMoveStats &stats = advice.moves[i];
+        out << combatMoveName(stats.move);
+        if (stats.move.action == CombatAction::USE_ITEM)
         {
-            std::cout << "\nExiting game...\n";
-            exit(0);
+            out << " (" << ItemRegistry::get(stats.move.item).name << ")";
         }
+        out << ": score " << static_cast<int>(stats.meanValue * 100 + 0.5) << '\n';
+    }
+    out << "Suggested move: " << combatMoveName(advice.best);
+    if (advice.best.action == CombatAction::USE_ITEM)
+    {
+        out << " (" << ItemRegistry::get(advice.best.item).name << ")";
+    }
+    out << '\n';
+    co_await waitForEnter();
+}
+
+// Read lines until one is a number, running any slash commands on the way
+Task<int> Game::readIntInput()
+{
+    static_assert(sizeof(COMMAND_HANDLERS) / sizeof(COMMAND_HANDLERS[0]) == static_cast<std::size_t>(CommandId::COUNT),
+                  "every command needs a handler");
+
+    std::string line;
+
+    while (true)
+    {
+        co_await readLine(line);
 
-        try
+        if (!line.empty() && line.front() == '/')
         {
-            if (input.empty())
+            if (std::optional<CommandId> command = findCommand(line))
             {
-                std::cout << "Please enter a number: ";
+                co_await (this->*COMMAND_HANDLERS[static_cast<std::size_t>(*command)])();
+                out << "\nEnter your choice: ";
                 continue;
             }
+        }
 
-            // Check if input is numeric
-            for (char c : input)
-            {
-                if (!std::isdigit(c))
-                {
-                    throw std::invalid_argument("Not a number");
-                }
-            }
-
-            choice = std::stoi(input);
-            validInput = true;
+        if (line.empty())
+        {
+            out << "Please enter a number: ";
+            continue;
         }
-        catch (const std::exception &)
+
+        if (std::optional<int> choice = parseChoice(line))
         {
-            std::cout << "Invalid input. Please enter a number (or type /help for commands): ";
+            co_return *choice;
         }
+        out << "Invalid input. Please enter a number (or type /help for commands): ";
     }
-
-    return choice;
 }
 
-// Static pointer to the current player for command access
-Player *Game::currentPlayerPtr = nullptr;
-
-Game::Game()
+Game::Game(DecisionPolicy *policy, std::uint64_t seed, OutputSink *sink, InputSource *input)
     : currentState(GameState::MAIN_MENU),
       player("Adventurer"),
+      currentNpc(NO_NPC),
       currentDungeonLevel(1),
       maxDungeonLevel(5),
-      currentEnemyIndex(-1)
+      currentEnemyIndex(-1),
+      encounterFieldReady(false),
+      turnCount(0),
+      rng(seed),
+      metrics(policy == nullptr),
+      recorder(nullptr),
+      policy(policy),
+      ownedSink(sink ? nullptr : makeDefaultSink(policy != nullptr)),
+      out(sink ? *sink : *ownedSink),
+      ownedInput(input || policy ? nullptr : std::make_unique<ConsoleInput>()),
+      input(input ? input : ownedInput.get()),
+      exitRequested(false)
 {
+    events.setSession(seed);
     initializeGame();
-
-    // Set up signal handlers
-    std::signal(SIGINT, signalHandler); // Ctrl+C
-
-    // Set the static player pointer
-    currentPlayerPtr = &player;
 }
 
-Player *Game::getCurrentPlayer()
+Game::~Game()
 {
-    return currentPlayerPtr;
+    events.flush();
+    out.drain();
 }
 
 void Game::initializeGame()
 {
+    // The deepest level holds the most enemies plus the bosses; sizing for it
+    // up front means moving between levels never touches the heap
+    enemies.reserve(3 + maxDungeonLevel + EnemyRegistry::bossCount());
+
     createNPCs();
     createEnemies();
 
     // Add some starter items to player's inventory
-    player.addItem(Item("Health Potion", "Restores 50% of your max health", "🧪", true));
+    player.addItem(HEALTH_POTION, out);
 }
 
 void Game::createNPCs()
 {
     // Create friendly NPC named Nick
-    auto nick = std::make_unique<NPC>("Nick", "👨‍🦰", true);
-    nick->addDialogue("Welcome to the dungeon, adventurer! Be careful down there.");
-    nick->addDialogue("I've heard rumors of a powerful enemy lurking in the depths...");
-    nick->addDialogue("Need supplies? I've got potions and equipment for sale!");
-    nick->addDialogue("My evil twin brother NICK is causing trouble again. Can you stop him?");
+    NPC nick("Nick", "👨‍🦰", NPCRole::SHOPKEEPER);
+    nick.setDialogue(DialogueCorpus::find("nick"));
 
-    // Add shop items
-    nick->addShopItem("Health Potion", 20);
-    nick->addShopItem("Attack Boost", 50);
-    nick->addShopItem("Defense Boost", 50);
+    // Add shop items, in menu order
+    const BalanceParams &balance = Balance::get();
+    nick.addShopItem(ATTACK_BOOST, balance.attackBoostPrice);
+    nick.addShopItem(DEFENSE_BOOST, balance.defenseBoostPrice);
+    nick.addShopItem(HEALTH_POTION, balance.potionPrice);
 
-    npcs.push_back(std::move(nick));
+    npcs.clear();
+    currentNpc = npcs.add(std::move(nick));
 }
 
 void Game::createEnemies()
 {
-    // Clear existing enemies
-    enemies.clear();
+    // Recycle the previous level's enemy slots
+    enemies.reset();
 
     // Create regular enemies based on dungeon level
+    const EnemyArchetypeId *regular = EnemyRegistry::regular();
+    int regularCount = static_cast<int>(EnemyRegistry::regularCount());
     for (int i = 0; i < 3 + currentDungeonLevel; ++i)
     {
-        std::string name;
-        std::string emoji;
-        int health, attack, defense, xpReward, bdpReward;
+        enemies.emplace(regular[rng.spawning.uniformInt(0, regularCount - 1)], currentDungeonLevel);
+    }
 
-        // Randomize enemy type
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> distr(0, 3);
+    // Add the bosses at the last level
+    if (currentDungeonLevel == maxDungeonLevel)
+    {
+        for (std::size_t i = 0; i < EnemyRegistry::bossCount(); ++i)
+        {
+            enemies.emplace(EnemyRegistry::bosses()[i], currentDungeonLevel);
+        }
+    }
 
-        switch (distr(gen))
+    generateDungeon();
+}
+
+// Deeper levels span more chunks; nothing is generated until a tile is looked at
+void Game::generateDungeon()
+{
+    dungeon.reset(rng.getSeed(), currentDungeonLevel, levelExtent(currentDungeonLevel));
+    playerPosition = dungeon.startPosition();
+    encounterFieldReady = false;
+}
+
+// One search of the window around the player; each defeat afterwards only patches the field
+void Game::buildEncounterField()
+{
+    ChunkCoord first, last;
+    encounterWindow(playerPosition, dungeon.getExtent(), first, last);
+    encounterField.reset(dungeon, first, last.x - first.x + 1, last.y - first.y + 1);
+    for (std::size_t i = 0; i < enemies.size(); ++i)
+    {
+        if (enemies[i].isAlive())
         {
-        case 0:
-            name = "Goblin";
-            emoji = "👺";
-            health = 20 + currentDungeonLevel * 5;
-            attack = 5 + currentDungeonLevel * 2;
-            defense = 2 + currentDungeonLevel;
-            xpReward = 15 + currentDungeonLevel * 5;
-            bdpReward = 5 + currentDungeonLevel * 2;
-            break;
-        case 1:
-            name = "Skeleton";
-            emoji = "💀";
-            health = 15 + currentDungeonLevel * 4;
-            attack = 7 + currentDungeonLevel * 2;
-            defense = 1 + currentDungeonLevel;
-            xpReward = 20 + currentDungeonLevel * 5;
-            bdpReward = 7 + currentDungeonLevel * 2;
-            break;
-        case 2:
-            name = "Slime";
-            emoji = "🟢";
-            health = 25 + currentDungeonLevel * 6;
-            attack = 4 + currentDungeonLevel;
-            defense = 3 + currentDungeonLevel;
-            xpReward = 10 + currentDungeonLevel * 4;
-            bdpReward = 3 + currentDungeonLevel * 2;
-            break;
-        case 3:
-            name = "Bat";
-            emoji = "🦇";
-            health = 10 + currentDungeonLevel * 3;
-            attack = 6 + currentDungeonLevel * 2;
-            defense = 1 + currentDungeonLevel;
-            xpReward = 12 + currentDungeonLevel * 4;
-            bdpReward = 4 + currentDungeonLevel * 2;
-            break;
+            encounterField.addGoal(static_cast<std::uint16_t>(i), dungeon.encounterPosition(i));
         }
+    }
+    encounterField.build();
+    encounterFieldReady = true;
+}
 
-        enemies.push_back(std::make_unique<Enemy>(
-            name, health, attack, defense, xpReward, bdpReward, false, emoji));
+// Steps downhill on the encounter field until the player stands on an enemy
+int Game::walkToNearestEnemy(std::uint32_t &steps)
+{
+    ChunkCoord first, last;
+    encounterWindow(playerPosition, dungeon.getExtent(), first, last);
+    if (!encounterFieldReady || !encounterField.covers({first.x * CHUNK_SIZE, first.y * CHUNK_SIZE}) ||
+        !encounterField.covers({(last.x + 1) * CHUNK_SIZE - 1, (last.y + 1) * CHUNK_SIZE - 1}))
+    {
+        buildEncounterField(); // First walk of the level, or the player has left the window's middle
     }
 
-    // Add final boss at the last level
-    if (currentDungeonLevel == maxDungeonLevel)
+    steps = 0;
+    for (TilePos next = encounterField.next(playerPosition); next != playerPosition;
+         next = encounterField.next(playerPosition))
     {
-        enemies.push_back(std::make_unique<Enemy>(
-            "NICK", 200, 25, 15, 500, 1000, true, "😈"));
+        playerPosition = next;
+        steps++;
     }
+    // The walk ends on a goal's tile, which that goal owns
+    std::uint16_t reached = encounterField.nearestGoal(playerPosition);
+    return reached == FlowField::NO_GOAL || encounterField.distanceAt(playerPosition) != 0 ? -1 : reached;
 }
 
 void Game::run()
 {
-    while (currentState != GameState::GAME_OVER && currentState != GameState::VICTORY)
+    while (step())
     {
-        // Check if exit was requested via signal
-        if (exitRequested)
+    }
+}
+
+bool Game::step()
+{
+    if (!turn)
+    {
+        if (currentState == GameState::GAME_OVER || currentState == GameState::VICTORY)
         {
-            std::cout << "Game terminated by user." << std::endl;
-            currentState = GameState::GAME_OVER;
-            break;
+            return false;
         }
 
-        clearScreen();
+        // Check if exit was requested (e.g. Ctrl+C on the console)
+        if (exitRequested.load(std::memory_order_relaxed))
+        {
+            out << "Game terminated by user.\n";
+            setState(GameState::GAME_OVER);
+            return false;
+        }
 
-        switch (currentState)
+        if (recorder)
         {
-        case GameState::MAIN_MENU:
-            displayMainMenu();
-            break;
-        case GameState::EXPLORING:
-            handleExploring();
-            break;
-        case GameState::COMBAT:
-            handleCombat();
-            break;
-        case GameState::SHOP:
-            handleShop();
-            break;
-        case GameState::TALKING_TO_NPC:
-            handleNPCInteraction();
-            break;
-        case GameState::GAME_OVER:
-            displayGameOver();
-            break;
-        case GameState::VICTORY:
-            displayVictory();
-            break;
+            recorder->turnBoundary(*this);
         }
+
+        clearScreen();
+        metrics.beginTurn(currentState);
+        turn.emplace(playTurn());
+        turn->resume();
     }
+    else
+    {
+        // Pick the turn up where it waited for input
+        std::exchange(waitingForInput, nullptr).resume();
+    }
+
+    if (waitingForInput)
+    {
+        return true;
+    }
+
+    try
+    {
+        turn->result();
+    }
+    catch (const InputClosed &)
+    {
+        out.endFrame();
+        setState(GameState::GAME_OVER);
+    }
+    turn.reset();
+    metrics.endTurn();
+
+    return currentState != GameState::GAME_OVER && currentState != GameState::VICTORY;
+}
+
+Task<> Game::playTurn()
+{
+    switch (currentState)
+    {
+    case GameState::MAIN_MENU:
+        return displayMainMenu();
+    case GameState::EXPLORING:
+        return handleExploring();
+    case GameState::COMBAT:
+        return handleCombat();
+    case GameState::SHOP:
+        return handleShop();
+    case GameState::TALKING_TO_NPC:
+        return handleNPCInteraction();
+    case GameState::GAME_OVER:
+        return displayGameOver();
+    case GameState::VICTORY:
+        return displayVictory();
+    }
+    return Task<>::completed();
+}
+
+bool Game::isWaitingForInput() const
+{
+    return static_cast<bool>(waitingForInput);
 }
 
 void Game::setState(GameState newState)
 {
+    metrics.transition(currentState, newState);
+    emitEvent(CombatEventType::STATE_TRANSITION, EventActor::PLAYER, 0, static_cast<int>(newState),
+              static_cast<std::uint16_t>(currentState));
     currentState = newState;
 }
 
@@ -277,503 +538,812 @@ GameState Game::getState() const
     return currentState;
 }
 
-void Game::clearScreen()
+// Only the console game waits for effect; hosted and headless sessions must not hold a thread
+void Game::dramaticPause()
 {
-#ifdef _WIN32
-    system("cls");
-#else
-    system("clear");
-#endif
+    if (ownedInput)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+void Game::setRecorder(SessionRecorder *newRecorder)
+{
+    recorder = newRecorder;
+}
+
+void Game::setEventFile(CombatEventFile *file)
+{
+    events.setFile(file);
+}
+
+const CombatEventLog &Game::getEvents() const
+{
+    return events;
+}
+
+void Game::emitEvent(CombatEventType type, EventActor actor, int amount, int value, std::uint16_t subject)
+{
+    std::uint16_t enemy = currentEnemyIndex >= 0 && currentEnemyIndex < static_cast<int>(enemies.size())
+                              ? enemies[currentEnemyIndex].getArchetypeId()
+                              : NO_EVENT_ENEMY;
+    events.emit(type, actor, subject, amount, value, turnCount, currentDungeonLevel, enemy);
+}
+
+void Game::requestExit()
+{
+    exitRequested.store(true, std::memory_order_relaxed);
+}
+
+void Game::saveSnapshot(std::vector<char> &buffer) const
+{
+    SnapshotWriter writer(buffer, enemies.size());
+
+    SnapshotHeader &header = writer.header();
+    header.state = static_cast<std::int32_t>(currentState);
+    header.currentDungeonLevel = currentDungeonLevel;
+    header.maxDungeonLevel = maxDungeonLevel;
+    header.currentEnemyIndex = currentEnemyIndex;
+    header.turnCount = turnCount;
+    header.playerX = playerPosition.x;
+    header.playerY = playerPosition.y;
+    header.seed = rng.getSeed();
+    header.streamCounters[0] = rng.combat.getCounter();
+    header.streamCounters[1] = rng.loot.getCounter();
+    header.streamCounters[2] = rng.spawning.getCounter();
+    header.streamCounters[3] = rng.dialogue.getCounter();
+
+    SnapshotPlayer &saved = header.player;
+    saved.entity.health = player.getHealth();
+    saved.entity.maxHealth = player.getMaxHealth();
+    saved.entity.attack = player.getAttack();
+    saved.entity.defense = player.getDefense();
+    saved.level = player.getLevel();
+    saved.experience = player.getExperience();
+    saved.experienceToNextLevel = player.getExperienceToNextLevel();
+    saved.bdp = player.getBDP();
+    for (std::size_t id = 0; id < MAX_ITEM_TYPES; ++id)
+    {
+        saved.itemCounts[id] = player.getItemCounts()[id];
+    }
+
+    // addString may move the buffer, so records are looked up again after each call
+    SnapshotString name = writer.addString(player.getName());
+    writer.header().player.entity.name = name;
+
+    for (std::size_t i = 0; i < enemies.size(); ++i)
+    {
+        const Enemy &enemy = enemies[i];
+        SnapshotEnemy &record = writer.enemy(i);
+        record.level = enemy.getLevel();
+        record.health = enemy.getHealth();
+
+        SnapshotString archetype = writer.addString(enemy.getName());
+        writer.enemy(i).archetype = archetype;
+    }
+
+    writer.finish();
+}
+
+bool Game::captureImage(GameImage &image) const
+{
+    if (enemies.size() > MAX_IMAGE_ENEMIES)
+    {
+        return false;
+    }
+
+    image.state = static_cast<std::int32_t>(currentState);
+    image.currentDungeonLevel = currentDungeonLevel;
+    image.maxDungeonLevel = maxDungeonLevel;
+    image.currentEnemyIndex = currentEnemyIndex;
+    image.turnCount = turnCount;
+    image.enemyCount = static_cast<std::uint32_t>(enemies.size());
+    image.playerX = playerPosition.x;
+    image.playerY = playerPosition.y;
+    image.seed = rng.getSeed();
+    image.streamCounters[0] = rng.combat.getCounter();
+    image.streamCounters[1] = rng.loot.getCounter();
+    image.streamCounters[2] = rng.spawning.getCounter();
+    image.streamCounters[3] = rng.dialogue.getCounter();
+
+    image.health = player.getHealth();
+    image.maxHealth = player.getMaxHealth();
+    image.attack = player.getAttack();
+    image.defense = player.getDefense();
+    image.level = player.getLevel();
+    image.experience = player.getExperience();
+    image.experienceToNextLevel = player.getExperienceToNextLevel();
+    image.bdp = player.getBDP();
+    image.itemCounts = player.getItemCounts();
+
+    std::copy(enemies.begin(), enemies.end(), image.enemies);
+    return true;
 }
 
-void Game::pauseGame()
+void Game::restoreImage(const GameImage &image)
 {
-    std::cout << "\nPress Enter to continue...";
-    std::string input;
-    std::getline(std::cin, input);
+    // Any turn in progress belongs to the state being replaced
+    waitingForInput = nullptr;
+    turn.reset();
+
+    currentState = static_cast<GameState>(image.state);
+    currentDungeonLevel = image.currentDungeonLevel;
+    maxDungeonLevel = image.maxDungeonLevel;
+    currentEnemyIndex = image.currentEnemyIndex;
+    turnCount = image.turnCount;
+
+    // Stream keys only depend on the seed, so they are rebuilt only for another game's image
+    if (image.seed != rng.getSeed())
+    {
+        rng = RandomService(image.seed);
+    }
+    rng.combat.setCounter(image.streamCounters[0]);
+    rng.loot.setCounter(image.streamCounters[1]);
+    rng.spawning.setCounter(image.streamCounters[2]);
+    rng.dialogue.setCounter(image.streamCounters[3]);
+
+    player.restoreStats(image.health, image.maxHealth, image.attack, image.defense,
+                        image.level, image.experience, image.experienceToNextLevel, image.bdp);
+    player.restoreInventory(image.itemCounts);
+
+    enemies.assign(image.enemies, image.enemyCount);
+    if (dungeon.getLevel() != currentDungeonLevel || dungeon.getSeed() != rng.getSeed())
+    {
+        generateDungeon();
+    }
+    playerPosition = {image.playerX, image.playerY};
+    encounterFieldReady = false; // Which enemies are alive may have changed
+}
+
+bool Game::loadSnapshot(const SnapshotView &snapshot)
+{
+    if (!snapshot.isValid())
+    {
+        return false;
+    }
+
+    const SnapshotHeader &header = snapshot.header();
+    if (header.state < static_cast<std::int32_t>(GameState::MAIN_MENU) ||
+        header.state > static_cast<std::int32_t>(GameState::VICTORY) ||
+        header.currentDungeonLevel < 1 || header.currentDungeonLevel > header.maxDungeonLevel ||
+        header.maxDungeonLevel > MAX_SNAPSHOT_DUNGEON_LEVEL || header.turnCount < 0)
+    {
+        return false;
+    }
+    // Every level has enemies, and never more than the last level's regulars plus the bosses
+    if (header.enemyCount < 1 ||
+        header.enemyCount > 3 + static_cast<std::uint32_t>(header.maxDungeonLevel) + EnemyRegistry::bossCount() ||
+        header.currentEnemyIndex < -1 || header.currentEnemyIndex >= static_cast<std::int32_t>(header.enemyCount))
+    {
+        return false;
+    }
+    const SnapshotPlayer &saved = header.player;
+    if (saved.entity.maxHealth <= 0 || saved.entity.maxHealth > MAX_SNAPSHOT_STAT || saved.entity.health < 0 ||
+        saved.entity.health > saved.entity.maxHealth ||
+        (saved.entity.health == 0 && header.state != static_cast<std::int32_t>(GameState::GAME_OVER)) ||
+        saved.entity.attack < 0 || saved.entity.attack > MAX_SNAPSHOT_STAT || saved.entity.defense < 0 ||
+        saved.entity.defense > MAX_SNAPSHOT_STAT || saved.level < 1 || saved.experienceToNextLevel < 1)
+    {
+        return false;
+    }
+    std::int64_t levelTiles = std::int64_t(levelExtent(header.currentDungeonLevel)) * CHUNK_SIZE;
+    if (header.playerX < 0 || header.playerY < 0 || header.playerX >= levelTiles || header.playerY >= levelTiles)
+    {
+        return false; // Off the level's map
+    }
+    // Defeated enemies stay listed only on the last level, where the game
+    // continues until the boss falls; elsewhere clearing the level replaces them
+    bool lastLevel = header.currentDungeonLevel == header.maxDungeonLevel;
+    for (std::uint32_t i = 0; i < header.enemyCount; ++i)
+    {
+        const SnapshotEnemy &record = snapshot.enemies()[i];
+        EnemyArchetypeId archetype = EnemyRegistry::find(snapshot.string(record.archetype));
+        if (archetype == NO_ARCHETYPE)
+        {
+            return false; // Saved with a content file that is not loaded
+        }
+        if (record.level < 1 || record.level > header.maxDungeonLevel || record.health < (lastLevel ? 0 : 1) ||
+            record.health > Enemy(archetype, record.level).getMaxHealth())
+        {
+            return false;
+        }
+    }
+
+    // Any turn in progress belongs to the state being replaced
+    waitingForInput = nullptr;
+    turn.reset();
+
+    currentState = static_cast<GameState>(header.state);
+    currentDungeonLevel = header.currentDungeonLevel;
+    maxDungeonLevel = header.maxDungeonLevel;
+    currentEnemyIndex = header.currentEnemyIndex;
+    turnCount = header.turnCount;
 
-    // Check for EOF (Ctrl+D)
-    if (std::cin.eof())
+    rng = RandomService(header.seed);
+    rng.combat.setCounter(header.streamCounters[0]);
+    rng.loot.setCounter(header.streamCounters[1]);
+    rng.spawning.setCounter(header.streamCounters[2]);
+    rng.dialogue.setCounter(header.streamCounters[3]);
+
+    player = Player(std::string(snapshot.string(saved.entity.name)));
+    player.restoreStats(saved.entity.health, saved.entity.maxHealth, saved.entity.attack, saved.entity.defense,
+                        saved.level, saved.experience, saved.experienceToNextLevel, saved.bdp);
+
+    std::array<std::uint16_t, MAX_ITEM_TYPES> itemCounts;
+    for (std::size_t id = 0; id < MAX_ITEM_TYPES; ++id)
     {
-        std::cout << "\nExiting game...\n";
-        exit(0);
+        itemCounts[id] = saved.itemCounts[id];
     }
+    player.restoreInventory(itemCounts);
+
+    enemies.reset();
+    enemies.reserve(header.enemyCount);
+    for (std::uint32_t i = 0; i < header.enemyCount; ++i)
+    {
+        const SnapshotEnemy &record = snapshot.enemies()[i];
+        Enemy &enemy = enemies.emplace(EnemyRegistry::find(snapshot.string(record.archetype)), record.level);
+        enemy.setHealth(record.health);
+    }
+    generateDungeon();
+    playerPosition = {header.playerX, header.playerY};
+
+    return true;
+}
+
+bool Game::isHeadless() const
+{
+    return policy != nullptr;
 }
 
-void Game::displayMainMenu()
+int Game::getTurnCount() const
 {
-    std::cout << "🏰 DUNGEON CRAWLER RPG 🐉" << std::endl;
-    std::cout << "=========================" << std::endl;
-    std::cout << "\n1. Start New Game" << std::endl;
-    std::cout << "2. Exit" << std::endl;
-    std::cout << "\nEnter your choice: ";
+    return turnCount;
+}
+
+std::uint64_t Game::getSeed() const
+{
+    return rng.getSeed();
+}
 
-    int choice = getValidIntInput();
+int Game::getCurrentDungeonLevel() const
+{
+    return currentDungeonLevel;
+}
+
+int Game::getMaxDungeonLevel() const
+{
+    return maxDungeonLevel;
+}
+
+TilePos Game::getPlayerPosition() const
+{
+    return playerPosition;
+}
+
+const Player &Game::getPlayer() const
+{
+    return player;
+}
+
+const Enemy *Game::getCurrentEnemy() const
+{
+    if (currentEnemyIndex < 0 || currentEnemyIndex >= static_cast<int>(enemies.size()))
+    {
+        return nullptr;
+    }
+    return &enemies[currentEnemyIndex];
+}
+
+std::size_t Game::getEnemyPoolAllocations() const
+{
+    return enemies.getAllocationCount();
+}
+
+const NPC *Game::getShopkeeper() const
+{
+    if (!npcs.isValid(currentNpc) || !npcs.get(currentNpc).getIsShopkeeper())
+    {
+        return nullptr;
+    }
+    return &npcs.get(currentNpc);
+}
+
+Task<int> Game::readChoice(ChoicePrompt prompt)
+{
+    turnCount++;
+    if (policy)
+    {
+        return Task<int>::completed(policy->choose(*this, prompt));
+    }
+    return readIntInput();
+}
+
+void Game::clearScreen()
+{
+    if (isHeadless())
+    {
+        return;
+    }
+
+    out.clearScreen();
+}
+
+Task<> Game::pauseGame()
+{
+    if (isHeadless())
+    {
+        return Task<>::completed();
+    }
+    return waitForEnter();
+}
+
+Task<> Game::waitForEnter()
+{
+    out << "\nPress Enter to continue...";
+    std::string line;
+    co_await readLine(line);
+}
+
+Task<> Game::displayMainMenu()
+{
+    out << "🏰 DUNGEON CRAWLER RPG 🐉\n";
+    out << "=========================\n";
+    out << "\n1. Start New Game\n";
+    out << "2. Exit\n";
+    out << "\nEnter your choice: ";
+
+    int choice = co_await readChoice(ChoicePrompt::MAIN_MENU);
 
     switch (choice)
     {
     case 1:
-        std::cout << "\nWhat is your name, brave adventurer? ";
+        out << "\nWhat is your name, brave adventurer? ";
+        if (!isHeadless())
         {
             std::string playerName;
-            std::getline(std::cin, playerName);
+            co_await readLine(playerName);
             if (!playerName.empty())
             {
                 player = Player(playerName);
             }
         }
-        std::cout << "\nWelcome, " << player.getName() << "! Your adventure begins..." << std::endl;
-        pauseGame();
+        out << "\nWelcome, " << player.getName() << "! Your adventure begins...\n";
+        co_await pauseGame();
         setState(GameState::EXPLORING);
         break;
     case 2:
         setState(GameState::GAME_OVER);
         break;
     default:
-        std::cout << "\nInvalid choice. Please try again." << std::endl;
-        pauseGame();
+        out << "\nInvalid choice. Please try again.\n";
+        co_await pauseGame();
         break;
     }
 }
 
-void Game::displayGameOver()
+Task<> Game::displayGameOver()
 {
-    std::cout << "💀 GAME OVER 💀" << std::endl;
-    std::cout << "==============" << std::endl;
-    std::cout << "\nYour adventure has come to an end." << std::endl;
-    pauseGame();
+    out << "💀 GAME OVER 💀\n";
+    out << "==============\n";
+    out << "\nYour adventure has come to an end.\n";
+    co_await pauseGame();
 }
 
-void Game::displayVictory()
+Task<> Game::displayVictory()
 {
-    std::cout << "🎉 VICTORY! 🎉" << std::endl;
-    std::cout << "==============" << std::endl;
-    std::cout << "\nCongratulations, " << player.getName() << "!" << std::endl;
-    std::cout << "You have defeated NICK and saved the dungeon!" << std::endl;
-    std::cout << "\nFinal Stats:" << std::endl;
-    player.displayStats();
-    pauseGame();
+    out << "🎉 VICTORY! 🎉\n";
+    out << "==============\n";
+    out << "\nCongratulations, " << player.getName() << "!\n";
+    out << "You have defeated NICK and saved the dungeon!\n";
+    out << "\nFinal Stats:\n";
+    showPlayerStats();
+    co_await pauseGame();
 }
 
-void Game::handleExploring()
+Task<> Game::handleExploring()
 {
-    std::cout << "🧭 EXPLORING DUNGEON - LEVEL " << currentDungeonLevel << " 🧭" << std::endl;
-    std::cout << "===============================" << std::endl;
-    std::cout << "Type /help for available commands at any time." << std::endl;
+    out << "🧭 EXPLORING DUNGEON - LEVEL " << currentDungeonLevel << " 🧭\n";
+    out << "===============================\n";
+    out << "Type /help for available commands at any time.\n";
 
-    player.displayStats();
+    showPlayerStats();
 
-    std::cout << "\nWhat would you like to do?" << std::endl;
-    std::cout << "1. Look for enemies" << std::endl;
-    std::cout << "2. Talk to Nick" << std::endl;
-    std::cout << "3. Rest (restore some health)" << std::endl;
-    std::cout << "4. Check inventory" << std::endl;
-    std::cout << "5. Use item" << std::endl;
-    std::cout << "6. Exit game" << std::endl;
+    out << "\nWhat would you like to do?\n";
+    out << "1. Look for enemies\n";
+    out << "2. Talk to Nick\n";
+    out << "3. Rest (restore some health)\n";
+    out << "4. Check inventory\n";
+    out << "5. Use item\n";
+    out << "6. Exit game\n";
 
-    std::cout << "\nEnter your choice: ";
-    int choice = getValidIntInput();
+    out << "\nEnter your choice: ";
+    int choice = co_await readChoice(ChoicePrompt::EXPLORING);
 
     switch (choice)
     {
     case 1:
     {
-        std::cout << "\nLooking for enemies..." << std::endl;
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-
-        // Random chance to find an enemy
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> distr(0, enemies.size() - 1);
-
-        currentEnemyIndex = distr(gen);
-        std::cout << "You encountered a " << enemies[currentEnemyIndex]->getEmoji()
-                  << " " << enemies[currentEnemyIndex]->getName() << "!" << std::endl;
+        out << "\nLooking for enemies...\n";
+        dramaticPause();
+
+        // Players walk to the nearest enemy still standing. Bots skip the
+        // search and meet one by chance, which keeps headless runs fast.
+        std::uint32_t steps = 0;
+        int nearest = isHeadless() ? -1 : walkToNearestEnemy(steps);
+        if (nearest >= 0)
+        {
+            if (steps > 0)
+            {
+                out << "You follow the passages for " << steps << " steps...\n";
+            }
+            currentEnemyIndex = nearest;
+        }
+        else
+        {
+            currentEnemyIndex = rng.spawning.uniformInt(0, static_cast<int>(enemies.size()) - 1);
+            playerPosition = dungeon.encounterPosition(currentEnemyIndex);
+        }
+        out << "You encountered a " << enemies[currentEnemyIndex].getEmoji()
+                  << " " << enemies[currentEnemyIndex].getName() << "!\n";
 
-        pauseGame();
+        co_await pauseGame();
         setState(GameState::COMBAT);
         break;
     }
     case 2:
-        std::cout << "\nYou approach Nick..." << std::endl;
-        pauseGame();
+        out << "\nYou approach Nick...\n";
+        co_await pauseGame();
         setState(GameState::TALKING_TO_NPC);
         break;
     case 3:
     {
-        std::cout << "\nYou take a moment to rest..." << std::endl;
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        out << "\nYou take a moment to rest...\n";
+        dramaticPause();
 
         int healAmount = player.getMaxHealth() / 5; // Heal 20% of max health
-        player.heal(healAmount);
+        int healthBefore = player.getHealth();
+        player.heal(healAmount, out);
+        emitEvent(CombatEventType::HEAL, EventActor::PLAYER, player.getHealth() - healthBefore, player.getHealth());
 
-        pauseGame();
+        co_await pauseGame();
         break;
     }
     case 4:
-        player.displayInventory();
-        pauseGame();
+        player.displayInventory(out);
+        co_await pauseGame();
         break;
     case 5:
-        handleUseItem();
+        co_await handleUseItem();
         break;
     case 6:
         setState(GameState::GAME_OVER);
         break;
     default:
-        std::cout << "\nInvalid choice. Please try again." << std::endl;
-        pauseGame();
+        out << "\nInvalid choice. Please try again.\n";
+        co_await pauseGame();
         break;
     }
 }
 
-void Game::handleCombat()
+Task<> Game::handleCombat()
 {
+    // Each call plays a single combat turn; run() keeps dispatching here while in COMBAT
+
     // Use the enemy that was encountered in handleExploring
     if (currentEnemyIndex < 0 || currentEnemyIndex >= enemies.size())
     {
         // Fallback in case something went wrong
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> distr(0, enemies.size() - 1);
-        currentEnemyIndex = distr(gen);
+        currentEnemyIndex = rng.spawning.uniformInt(0, static_cast<int>(enemies.size()) - 1);
     }
 
-    Enemy &enemy = *enemies[currentEnemyIndex];
+    Enemy &enemy = enemies[currentEnemyIndex];
 
-    bool combatEnded = false;
+    out << "⚔️ COMBAT ⚔️\n";
+    out << "===========\n";
+    out << "Type /help for available commands at any time.\n";
 
-    while (!combatEnded)
-    {
-        clearScreen();
-        std::cout << "⚔️ COMBAT ⚔️" << std::endl;
-        std::cout << "===========" << std::endl;
-        std::cout << "Type /help for available commands at any time." << std::endl;
+    showPlayerStats();
+    out << '\n';
+    showEnemyStats(enemy);
 
-        player.displayStats();
-        std::cout << std::endl;
-        enemy.displayStats();
+    // Only worth computing when someone will read it
+    if (out.isEnabled())
+    {
+        FightEstimate odds = fightEstimator.estimate(player, enemy);
+        out << "\n🎲 If you keep attacking: " << static_cast<int>(odds.winProbability * 100 + 0.5)
+            << "% to win, about " << static_cast<int>(odds.expectedHealthIfWon + 0.5) << " health left\n";
+    }
 
-        std::cout << "\nWhat would you like to do?" << std::endl;
-        std::cout << "1. Attack" << std::endl;
-        std::cout << "2. Defend (reduce damage taken)" << std::endl;
-        std::cout << "3. Use item" << std::endl;
-        std::cout << "4. Check inventory" << std::endl;
-        std::cout << "5. Run away" << std::endl;
+    out << "\nWhat would you like to do?\n";
+    out << "1. Attack\n";
+    out << "2. Defend (reduce damage taken)\n";
+    out << "3. Use item\n";
+    out << "4. Check inventory\n";
+    out << "5. Run away\n";
 
-        std::cout << "\nEnter your choice: ";
-        int choice = getValidIntInput();
+    out << "\nEnter your choice: ";
+    int choice = co_await readChoice(ChoicePrompt::COMBAT);
 
-        switch (choice)
-        {
-        case 1:
+    switch (choice)
+    {
+    case 1:
+    {
+        // Player attacks
+        out << "\n"
+                  << player.getName() << " attacks " << enemy.getName() << "! ⚔️\n";
+        int damage = player.calculateDamage(rng.combat);
+        int healthBefore = enemy.getHealth();
+        enemy.takeDamage(damage, out);
+        emitEvent(CombatEventType::DAMAGE, EventActor::ENEMY, healthBefore - enemy.getHealth(), enemy.getHealth());
+
+        // Check if enemy is defeated
+        if (!enemy.isAlive())
         {
-            // Player attacks
-            std::cout << "\n"
-                      << player.getName() << " attacks " << enemy.getName() << "! ⚔️" << std::endl;
-            int damage = player.calculateDamage();
-            enemy.takeDamage(damage);
-
-            // Check if enemy is defeated
-            if (!enemy.isAlive())
+            out << "\nYou defeated the " << enemy.getEmoji() << " " << enemy.getName() << "! 🎉\n";
+
+            // Gain rewards
+            int levelBefore = player.getLevel();
+            player.gainExperience(enemy.getExperienceReward(), out);
+            emitEvent(CombatEventType::EXPERIENCE, EventActor::PLAYER, enemy.getExperienceReward(),
+                      player.getExperience());
+            if (player.getLevel() != levelBefore)
             {
-                std::cout << "\nYou defeated the " << enemy.getEmoji() << " " << enemy.getName() << "! 🎉" << std::endl;
-
-                // Gain rewards
-                player.gainExperience(enemy.getExperienceReward());
-                player.earnBDP(enemy.getBDPReward());
-
-                // Random chance to get an item
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::uniform_int_distribution<> distr(1, 10);
-
-                if (distr(gen) <= 3)
-                { // 30% chance
-                    player.addItem(Item("Health Potion", "Restores 50% of your max health", "🧪", true));
-                }
-
-                // Check if it was the final boss
-                if (enemy.getIsBoss())
-                {
-                    std::cout << "\n🎊 You have defeated the final boss, NICK! 🎊" << std::endl;
-                    pauseGame();
-                    setState(GameState::VICTORY);
-                    return;
-                }
-
-                // Move to next dungeon level if all enemies are defeated
-                if (currentDungeonLevel < maxDungeonLevel)
-                {
-                    std::cout << "\nYou've cleared this area! Moving to dungeon level "
-                              << (currentDungeonLevel + 1) << "..." << std::endl;
-                    currentDungeonLevel++;
-                    createEnemies(); // Generate new enemies for the next level
-                }
-
-                pauseGame();
-                setState(GameState::EXPLORING);
-                combatEnded = true;
-                break;
+                emitEvent(CombatEventType::LEVEL_UP, EventActor::PLAYER, player.getLevel() - levelBefore,
+                          player.getLevel());
+            }
+            player.earnBDP(enemy.getBDPReward(), out);
+            emitEvent(CombatEventType::BDP, EventActor::PLAYER, enemy.getBDPReward(), player.getBDP());
+
+            // Random chance to get an item
+            if (rng.loot.uniformInt(1, 10) <= Balance::get().potionDropInTen)
+            { // 30% chance by default
+                player.addItem(HEALTH_POTION, out);
+                emitEvent(CombatEventType::ITEM_DROP, EventActor::ENEMY, 1, player.getItemCount(HEALTH_POTION),
+                          HEALTH_POTION);
             }
 
-            // Enemy attacks
-            std::cout << "\n"
-                      << enemy.getEmoji() << " " << enemy.getName() << " attacks you! ⚔️" << std::endl;
-            damage = enemy.calculateDamage();
-            player.takeDamage(damage);
+            // Check if it was the final boss
+            if (enemy.getIsBoss())
+            {
+                out << "\n🎊 You have defeated the final boss, NICK! 🎊\n";
+                co_await pauseGame();
+                setState(GameState::VICTORY);
+                co_return;
+            }
 
-            // Check if player is defeated
-            if (!player.isAlive())
+            // Move to next dungeon level if all enemies are defeated
+            if (currentDungeonLevel < maxDungeonLevel)
             {
-                std::cout << "\nYou have been defeated! 💀" << std::endl;
-                pauseGame();
-                setState(GameState::GAME_OVER);
-                combatEnded = true;
-                break;
+                out << "\nYou've cleared this area! Moving to dungeon level "
+                          << (currentDungeonLevel + 1) << "...\n";
+                currentDungeonLevel++;
+                createEnemies(); // Generate new enemies for the next level
+            }
+            else if (encounterFieldReady)
+            {
+                encounterField.removeGoal(static_cast<std::uint16_t>(currentEnemyIndex));
             }
 
-            pauseGame();
+            co_await pauseGame();
+            setState(GameState::EXPLORING);
             break;
         }
-        case 2:
+
+        // Enemy attacks
+        out << "\n"
+                  << enemy.getEmoji() << " " << enemy.getName() << " attacks you! ⚔️\n";
+        damage = enemy.calculateDamage(rng.combat);
+        healthBefore = player.getHealth();
+        player.takeDamage(damage, out);
+        emitEvent(CombatEventType::DAMAGE, EventActor::PLAYER, healthBefore - player.getHealth(), player.getHealth());
+
+        // Check if player is defeated
+        if (!player.isAlive())
         {
-            // Player defends (temporarily increase defense)
-            std::cout << "\n"
-                      << player.getName() << " takes a defensive stance! 🛡️" << std::endl;
-            int tempDefenseBoost = 5;
-            int originalDefense = player.getDefense();
+            out << "\nYou have been defeated! 💀\n";
+            co_await pauseGame();
+            setState(GameState::GAME_OVER);
+            break;
+        }
 
-            // Enemy attacks with reduced damage
-            std::cout << "\n"
-                      << enemy.getEmoji() << " " << enemy.getName() << " attacks you! ⚔️" << std::endl;
-            int damage = enemy.calculateDamage() - tempDefenseBoost;
-            if (damage < 1)
-                damage = 1;
+        co_await pauseGame();
+        break;
+    }
+    case 2:
+    {
+        // Player defends (temporarily increase defense)
+        out << "\n"
+                  << player.getName() << " takes a defensive stance! 🛡️\n";
+        int tempDefenseBoost = Balance::get().defendBonus;
+        int originalDefense = player.getDefense();
+
+        // Enemy attacks with reduced damage
+        out << "\n"
+                  << enemy.getEmoji() << " " << enemy.getName() << " attacks you! ⚔️\n";
+        int damage = enemy.calculateDamage(rng.combat) - tempDefenseBoost;
+        if (damage < 1)
+            damage = 1;
+
+        int healthBefore = player.getHealth();
+        player.takeDamage(damage, out);
+        emitEvent(CombatEventType::DAMAGE, EventActor::PLAYER, healthBefore - player.getHealth(), player.getHealth());
+
+        // Check if player is defeated
+        if (!player.isAlive())
+        {
+            out << "\nYou have been defeated! 💀\n";
+            co_await pauseGame();
+            setState(GameState::GAME_OVER);
+            break;
+        }
 
-            player.takeDamage(damage);
+        co_await pauseGame();
+        break;
+    }
+    case 3:
+        co_await handleUseItem();
+        break;
+    case 4:
+        player.displayInventory(out);
+        co_await pauseGame();
+        break;
+    case 5:
+    {
+        // Attempt to run away
+        int escapeChance = rng.combat.uniformInt(1, 10);
+
+        if (escapeChance > 10 - Balance::get().escapeInTen || enemy.getIsBoss())
+        { // 70% chance to escape by default, can't escape from boss
+            out << "\nYou successfully escaped! 🏃‍♂️💨\n";
+            co_await pauseGame();
+            setState(GameState::EXPLORING);
+        }
+        else
+        {
+            out << "\nYou failed to escape! 😱\n";
+
+            // Enemy gets a free attack
+            out << "\n"
+                      << enemy.getEmoji() << " " << enemy.getName() << " attacks you! ⚔️\n";
+            int damage = enemy.calculateDamage(rng.combat);
+            int healthBefore = player.getHealth();
+            player.takeDamage(damage, out);
+            emitEvent(CombatEventType::DAMAGE, EventActor::PLAYER, healthBefore - player.getHealth(), player.getHealth());
 
             // Check if player is defeated
             if (!player.isAlive())
             {
-                std::cout << "\nYou have been defeated! 💀" << std::endl;
-                pauseGame();
+                out << "\nYou have been defeated! 💀\n";
+                co_await pauseGame();
                 setState(GameState::GAME_OVER);
-                combatEnded = true;
                 break;
             }
 
-            pauseGame();
-            break;
-        }
-        case 3:
-            handleUseItem();
-            break;
-        case 4:
-            player.displayInventory();
-            pauseGame();
-            break;
-        case 5:
-        {
-            // Attempt to run away
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_int_distribution<> distr(1, 10);
-
-            int escapeChance = distr(gen);
-
-            if (escapeChance > 3 || enemy.getIsBoss())
-            { // 70% chance to escape, can't escape from boss
-                std::cout << "\nYou successfully escaped! 🏃‍♂️💨" << std::endl;
-                pauseGame();
-                setState(GameState::EXPLORING);
-                combatEnded = true;
-            }
-            else
-            {
-                std::cout << "\nYou failed to escape! 😱" << std::endl;
-
-                // Enemy gets a free attack
-                std::cout << "\n"
-                          << enemy.getEmoji() << " " << enemy.getName() << " attacks you! ⚔️" << std::endl;
-                int damage = enemy.calculateDamage();
-                player.takeDamage(damage);
-
-                // Check if player is defeated
-                if (!player.isAlive())
-                {
-                    std::cout << "\nYou have been defeated! 💀" << std::endl;
-                    pauseGame();
-                    setState(GameState::GAME_OVER);
-                    combatEnded = true;
-                    break;
-                }
-
-                pauseGame();
-            }
-            break;
-        }
-        default:
-            std::cout << "\nInvalid choice. Please try again." << std::endl;
-            pauseGame();
-            break;
+            co_await pauseGame();
         }
+        break;
+    }
+    default:
+        out << "\nInvalid choice. Please try again.\n";
+        co_await pauseGame();
+        break;
     }
 }
 
-void Game::handleShop()
+Task<> Game::handleShop()
 {
     clearScreen();
-    std::cout << "🛒 SHOP 🛒" << std::endl;
-    std::cout << "=========" << std::endl;
+    out << "🛒 SHOP 🛒\n";
+    out << "=========\n";
 
     // Find Nick (the shopkeeper)
-    NPC *shopkeeper = nullptr;
-    for (const auto &npc : npcs)
-    {
-        if (npc->getName() == "Nick" && npc->getIsShopkeeper())
-        {
-            shopkeeper = npc.get();
-            break;
-        }
-    }
+    const NPC *shopkeeper = getShopkeeper();
 
     if (!shopkeeper)
     {
-        std::cout << "Shop is currently closed. Please come back later." << std::endl;
-        pauseGame();
+        out << "Shop is currently closed. Please come back later.\n";
+        co_await pauseGame();
         setState(GameState::EXPLORING);
-        return;
+        co_return;
     }
 
-    std::cout << shopkeeper->getEmoji() << " " << shopkeeper->getName() << ": \"Welcome to my shop!\"" << std::endl;
+    out << shopkeeper->getEmoji() << " " << shopkeeper->getName() << ": \"Welcome to my shop!\"\n";
 
-    player.displayStats();
-    std::cout << "\nAvailable Items:" << std::endl;
+    showPlayerStats();
+    out << "\nAvailable Items:\n";
 
-    const auto &shopItems = shopkeeper->getShopItems();
+    const ShopCatalog &shop = shopkeeper->getShop();
     int itemIndex = 1;
-    for (const auto &item : shopItems)
+    for (const ShopEntry &entry : shop)
     {
-        std::cout << itemIndex << ". " << item.first << " - " << item.second << " BDP" << std::endl;
+        out << itemIndex << ". " << ItemRegistry::get(entry.item).name << " - " << entry.price << " BDP\n";
         itemIndex++;
     }
 
-    std::cout << itemIndex << ". Check inventory" << std::endl;
-    std::cout << (itemIndex + 1) << ". Exit Shop" << std::endl;
+    out << itemIndex << ". Check inventory\n";
+    out << (itemIndex + 1) << ". Exit Shop\n";
 
-    std::cout << "\nEnter your choice: ";
-    int choice = getValidIntInput();
+    out << "\nEnter your choice: ";
+    int choice = co_await readChoice(ChoicePrompt::SHOP);
 
     if (choice == itemIndex)
     {
         // Check inventory
-        player.displayInventory();
-        pauseGame();
-        return;
+        player.displayInventory(out);
+        co_await pauseGame();
+        co_return;
     }
     else if (choice == itemIndex + 1)
     {
         // Exit shop
         setState(GameState::EXPLORING);
-        return;
+        co_return;
     }
 
-    if (choice < 1 || choice > shopItems.size())
+    if (choice < 1 || choice > static_cast<int>(shop.size()))
     {
-        std::cout << "\nInvalid choice. Please try again." << std::endl;
-        pauseGame();
-        return;
+        out << "\nInvalid choice. Please try again.\n";
+        co_await pauseGame();
+        co_return;
     }
 
-    // Find the selected item
-    auto it = shopItems.begin();
-    std::advance(it, choice - 1);
-
-    std::string itemName = it->first;
-    int itemPrice = it->second;
+    // Menu choice n is catalog entry n - 1
+    const ShopEntry &entry = shop[choice - 1];
+    int itemPrice = entry.price;
 
     // Check if player has enough BDP
     if (player.getBDP() < itemPrice)
     {
-        std::cout << "\nYou don't have enough BDP to buy this item! 😢" << std::endl;
-        pauseGame();
-        return;
+        out << "\nYou don't have enough BDP to buy this item! 😢\n";
+        co_await pauseGame();
+        co_return;
     }
 
     // Purchase the item
-    player.spendBDP(itemPrice);
+    player.spendBDP(itemPrice, out);
+    emitEvent(CombatEventType::BDP, EventActor::PLAYER, -itemPrice, player.getBDP());
 
     // Add item to inventory
-    std::string emoji;
-    std::string description;
-    bool isConsumable = true;
-
-    if (itemName == "Health Potion")
-    {
-        emoji = "🧪";
-        description = "Restores 50% of your max health";
-    }
-    else if (itemName == "Attack Boost")
-    {
-        emoji = "💪";
-        description = "Permanently increases your attack by 5";
-    }
-    else if (itemName == "Defense Boost")
-    {
-        emoji = "🛡️";
-        description = "Permanently increases your defense by 3";
-    }
+    player.addItem(entry.item, out);
 
-    player.addItem(Item(itemName, description, emoji, isConsumable));
-
-    std::cout << "\nThank you for your purchase!" << std::endl;
-    pauseGame();
+    out << "\nThank you for your purchase!\n";
+    co_await pauseGame();
 }
 
-void Game::handleNPCInteraction()
+Task<> Game::handleNPCInteraction()
 {
     clearScreen();
-    std::cout << "💬 TALKING TO NPC 💬" << std::endl;
-    std::cout << "===================" << std::endl;
+    out << "💬 TALKING TO NPC 💬\n";
+    out << "===================\n";
 
-    // Find Nick
-    NPC *nick = nullptr;
-    for (const auto &npc : npcs)
-    {
-        if (npc->getName() == "Nick")
-        {
-            nick = npc.get();
-            break;
-        }
-    }
+    const NPC *nick = npcs.isValid(currentNpc) ? &npcs.get(currentNpc) : nullptr;
 
     if (!nick)
     {
-        std::cout << "Nick is not available right now." << std::endl;
-        pauseGame();
+        out << "Nick is not available right now.\n";
+        co_await pauseGame();
         setState(GameState::EXPLORING);
-        return;
+        co_return;
     }
 
-    nick->displayInfo();
+    nick->displayInfo(rng.dialogue, out);
 
-    std::cout << "\nWhat would you like to do?" << std::endl;
-    std::cout << "1. Talk to " << nick->getName() << std::endl;
-    std::cout << "2. Shop" << std::endl;
-    std::cout << "3. Check inventory" << std::endl;
-    std::cout << "4. Leave" << std::endl;
+    out << "\nWhat would you like to do?\n";
+    out << "1. Talk to " << nick->getName() << '\n';
+    out << "2. Shop\n";
+    out << "3. Check inventory\n";
+    out << "4. Leave\n";
 
-    std::cout << "\nEnter your choice: ";
-    int choice = getValidIntInput();
+    out << "\nEnter your choice: ";
+    int choice = co_await readChoice(ChoicePrompt::TALKING_TO_NPC);
 
     switch (choice)
     {
     case 1:
-        std::cout << "\n"
+        out << "\n"
                   << nick->getEmoji() << " " << nick->getName() << ": \""
-                  << nick->getRandomDialogue() << "\"" << std::endl;
-        pauseGame();
+                  << nick->getRandomDialogue(rng.dialogue) << "\"\n";
+        co_await pauseGame();
         break;
     case 2:
         if (nick->getIsShopkeeper())
@@ -782,58 +1352,63 @@ void Game::handleNPCInteraction()
         }
         else
         {
-            std::cout << "\n"
-                      << nick->getName() << " doesn't have anything to sell." << std::endl;
-            pauseGame();
+            out << "\n"
+                      << nick->getName() << " doesn't have anything to sell.\n";
+            co_await pauseGame();
         }
         break;
     case 3:
-        player.displayInventory();
-        pauseGame();
+        player.displayInventory(out);
+        co_await pauseGame();
         break;
     case 4:
         setState(GameState::EXPLORING);
         break;
     default:
-        std::cout << "\nInvalid choice. Please try again." << std::endl;
-        pauseGame();
+        out << "\nInvalid choice. Please try again.\n";
+        co_await pauseGame();
         break;
     }
 }
 
-void Game::handleUseItem()
+Task<> Game::handleUseItem()
 {
+    MetricsSpan span(metrics, MetricsHandler::USE_ITEM);
     clearScreen();
-    std::cout << "🎒 USE ITEM 🎒" << std::endl;
-    std::cout << "=============" << std::endl;
+    out << "🎒 USE ITEM 🎒\n";
+    out << "=============\n";
 
-    player.displayInventory();
+    player.displayInventory(out);
 
-    if (player.getInventory().empty())
+    if (!player.hasItems())
     {
-        pauseGame();
-        return;
+        co_await pauseGame();
+        co_return;
     }
 
-    std::cout << "\nEnter the number of the item to use (0 to cancel): ";
-    int choice = getValidIntInput();
+    out << "\nEnter the number of the item to use (0 to cancel): ";
+    int choice = co_await readChoice(ChoicePrompt::USE_ITEM);
 
     if (choice == 0)
     {
-        return;
+        co_return;
     }
 
-    if (choice < 1 || choice > player.getInventory().size())
+    // Get the selected item
+    ItemId selectedItem = player.getItemAtSlot(choice);
+    if (selectedItem == NO_ITEM)
     {
-        std::cout << "\nInvalid choice. Please try again." << std::endl;
-        pauseGame();
-        return;
+        out << "\nInvalid choice. Please try again.\n";
+        co_await pauseGame();
+        co_return;
     }
 
-    // Get the selected item
-    const Item &selectedItem = player.getInventory()[choice - 1];
-
     // Use the item
-    player.useItem(selectedItem.name);
-    pauseGame();
+    int healthBefore = player.getHealth();
+    player.useItem(selectedItem, out);
+    if (player.getHealth() > healthBefore)
+    {
+        emitEvent(CombatEventType::HEAL, EventActor::PLAYER, player.getHealth() - healthBefore, player.getHealth());
+    }
+    co_await pauseGame();
 }
\ No newline at end of file
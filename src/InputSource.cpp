@@ -0,0 +1,71 @@
+#include "InputSource.h"
+#include <iostream>
+
+InputStatus ConsoleInput::readLine(std::string &line)
+{
+    // Check for EOF (Ctrl+D)
+    return std::getline(std::cin, line) ? InputStatus::LINE : InputStatus::CLOSED;
+}
+
+ScriptedInput::ScriptedInput(std::vector<std::string> lines)
+    : lines(std::move(lines)), next(0) {}
+
+InputStatus ScriptedInput::readLine(std::string &line)
+{
+    if (next >= lines.size())
+    {
+        return InputStatus::CLOSED;
+    }
+    line = lines[next++];
+    return InputStatus::LINE;
+}
+
+QueueInput::QueueInput()
+    : closed(false) {}
+
+void QueueInput::push(std::string line)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        lines.push_back(std::move(line));
+    }
+    if (listener)
+    {
+        listener();
+    }
+}
+
+void QueueInput::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    if (listener)
+    {
+        listener();
+    }
+}
+
+void QueueInput::setListener(std::function<void()> callback)
+{
+    listener = std::move(callback);
+}
+
+bool QueueInput::hasInput() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return !lines.empty() || closed;
+}
+
+InputStatus QueueInput::readLine(std::string &line)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (lines.empty())
+    {
+        return closed ? InputStatus::CLOSED : InputStatus::PENDING;
+    }
+    line = std::move(lines.front());
+    lines.pop_front();
+    return InputStatus::LINE;
+}
@@ -0,0 +1,40 @@
+#include "Item.h"
+
+namespace
+{
+    const ItemInfo ITEMS[] = {
+        {"Health Potion", "Restores 50% of your max health", "🧪", true, ItemEffect::HEAL_PERCENT, 50},
+        {"Attack Boost", "Permanently increases your attack by 5", "💪", true, ItemEffect::ATTACK_BONUS, 5},
+        {"Defense Boost", "Permanently increases your defense by 3", "🛡️", true, ItemEffect::DEFENSE_BONUS, 3},
+    };
+
+    const std::size_t ITEM_COUNT = sizeof(ITEMS) / sizeof(ITEMS[0]);
+    static_assert(ITEM_COUNT <= MAX_ITEM_TYPES, "raise MAX_ITEM_TYPES to add more items");
+}
+
+std::size_t ItemRegistry::size()
+{
+    return ITEM_COUNT;
+}
+
+bool ItemRegistry::isValid(ItemId id)
+{
+    return id < ITEM_COUNT;
+}
+
+const ItemInfo &ItemRegistry::get(ItemId id)
+{
+    return ITEMS[id];
+}
+
+ItemId ItemRegistry::find(std::string_view name)
+{
+    for (std::size_t i = 0; i < ITEM_COUNT; ++i)
+    {
+        if (ITEMS[i].name == name)
+        {
+            return static_cast<ItemId>(i);
+        }
+    }
+    return NO_ITEM;
+}
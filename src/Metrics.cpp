@@ -0,0 +1,476 @@
+#include "Metrics.h"
+#include "Game.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace
+{
+    // Latency buckets: upper bounds of 256 ns doubling up to about 34 s, then +Inf
+    const std::size_t LATENCY_BUCKETS = 28;
+    const std::uint64_t FIRST_LATENCY_BOUND = 256;
+
+    // Turns a combat took
+    const int COMBAT_TURN_BOUNDS[] = {1, 2, 3, 4, 5, 6, 8, 10, 15, 20, 30, 50};
+    const std::size_t COMBAT_TURN_BUCKETS = METRICS_COMBAT_TURN_BUCKETS;
+    static_assert(sizeof(COMBAT_TURN_BOUNDS) / sizeof(COMBAT_TURN_BOUNDS[0]) == COMBAT_TURN_BUCKETS,
+                  "one bound per combat turn bucket");
+
+    const char *const HANDLER_NAMES[] = {
+        "main_menu", "exploring", "combat", "shop", "talking_to_npc", "game_over", "victory", "use_item"};
+    static_assert(sizeof(HANDLER_NAMES) / sizeof(HANDLER_NAMES[0]) == METRICS_HANDLER_COUNT,
+                  "every handler needs a label");
+
+    // Written by one thread only, so an increment is a plain load and store;
+    // the atomics just make the exporter's concurrent reads well-defined
+    struct Counter
+    {
+        std::atomic<std::uint64_t> value{0};
+
+        void add(std::uint64_t amount)
+        {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+        std::uint64_t get() const { return value.load(std::memory_order_relaxed); }
+    };
+
+    template <std::size_t Buckets>
+    struct Histogram
+    {
+        Counter buckets[Buckets + 1]; // Last one is +Inf
+        Counter sum;
+
+        void observe(std::size_t bucket, std::uint64_t value)
+        {
+            buckets[bucket < Buckets ? bucket : Buckets].add(1);
+            sum.add(value);
+        }
+
+        void merge(const std::uint32_t *counts, std::uint64_t total)
+        {
+            for (std::size_t b = 0; b <= Buckets; ++b)
+            {
+                if (counts[b])
+                {
+                    buckets[b].add(counts[b]);
+                }
+            }
+            sum.add(total);
+        }
+    };
+
+    struct MetricsShard
+    {
+        Counter turns[METRICS_HANDLER_COUNT];
+        Histogram<LATENCY_BUCKETS> compute[METRICS_HANDLER_COUNT];
+        Histogram<LATENCY_BUCKETS> inputWait[METRICS_HANDLER_COUNT];
+        Counter transitions[METRICS_STATE_COUNT][METRICS_STATE_COUNT];
+        Histogram<COMBAT_TURN_BUCKETS> combatTurns;
+        std::uint32_t nextSamplePhase = 0; // Staggers the sampled turns of new games
+    };
+
+    // Shards outlive their threads so finished sessions still count
+    std::mutex shardsMutex;
+    std::vector<std::unique_ptr<MetricsShard>> shards;
+
+    [[maybe_unused]] MetricsShard &localShard()
+    {
+        thread_local MetricsShard *shard = nullptr;
+        if (!shard)
+        {
+            std::lock_guard<std::mutex> lock(shardsMutex);
+            shards.push_back(std::make_unique<MetricsShard>());
+            shard = shards.back().get();
+        }
+        return *shard;
+    }
+
+    [[maybe_unused]] std::uint64_t nowNs()
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+
+    [[maybe_unused]] std::size_t latencyBucket(std::uint64_t ns)
+    {
+        return ns == 0 ? 0 : std::bit_width((ns - 1) / FIRST_LATENCY_BOUND); // ns <= 256 << i lands in bucket i
+    }
+
+    [[maybe_unused]] std::size_t combatTurnBucket(int turns)
+    {
+        std::size_t bucket = 0;
+        while (bucket < COMBAT_TURN_BUCKETS && turns > COMBAT_TURN_BOUNDS[bucket])
+        {
+            bucket++;
+        }
+        return bucket;
+    }
+
+    std::size_t handlerIndex(MetricsHandler handler)
+    {
+        return static_cast<std::size_t>(handler);
+    }
+
+    // Totals over every shard
+    struct Totals
+    {
+        std::uint64_t turns[METRICS_HANDLER_COUNT] = {};
+        std::uint64_t compute[METRICS_HANDLER_COUNT][LATENCY_BUCKETS + 1] = {};
+        std::uint64_t computeSum[METRICS_HANDLER_COUNT] = {};
+        std::uint64_t inputWait[METRICS_HANDLER_COUNT][LATENCY_BUCKETS + 1] = {};
+        std::uint64_t inputWaitSum[METRICS_HANDLER_COUNT] = {};
+        std::uint64_t transitions[METRICS_STATE_COUNT][METRICS_STATE_COUNT] = {};
+        std::uint64_t combatTurns[COMBAT_TURN_BUCKETS + 1] = {};
+        std::uint64_t combatTurnsSum = 0;
+    };
+
+    void collect(Totals &total)
+    {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        for (const std::unique_ptr<MetricsShard> &shard : shards)
+        {
+            for (std::size_t h = 0; h < METRICS_HANDLER_COUNT; ++h)
+            {
+                total.turns[h] += shard->turns[h].get();
+                for (std::size_t b = 0; b <= LATENCY_BUCKETS; ++b)
+                {
+                    total.compute[h][b] += shard->compute[h].buckets[b].get();
+                    total.inputWait[h][b] += shard->inputWait[h].buckets[b].get();
+                }
+                total.computeSum[h] += shard->compute[h].sum.get();
+                total.inputWaitSum[h] += shard->inputWait[h].sum.get();
+            }
+            for (std::size_t from = 0; from < METRICS_STATE_COUNT; ++from)
+            {
+                for (std::size_t to = 0; to < METRICS_STATE_COUNT; ++to)
+                {
+                    total.transitions[from][to] += shard->transitions[from][to].get();
+                }
+            }
+            for (std::size_t b = 0; b <= COMBAT_TURN_BUCKETS; ++b)
+            {
+                total.combatTurns[b] += shard->combatTurns.buckets[b].get();
+            }
+            total.combatTurnsSum += shard->combatTurns.sum.get();
+        }
+    }
+
+    void appendNumber(std::string &text, double value)
+    {
+        char digits[32];
+        std::snprintf(digits, sizeof(digits), "%.9g", value);
+        text += digits;
+    }
+
+    void appendHeader(std::string &text, const char *name, const char *type, const char *help)
+    {
+        text += "# HELP ";
+        text += name;
+        text += ' ';
+        text += help;
+        text += "\n# TYPE ";
+        text += name;
+        text += ' ';
+        text += type;
+        text += '\n';
+    }
+
+    // Cumulative buckets, _sum and _count for one labelled series
+    void appendHistogram(std::string &text, const char *name, const std::string &labels,
+                         const std::uint64_t *buckets, std::size_t bucketCount,
+                         const double *bounds, double sum)
+    {
+        std::uint64_t cumulative = 0;
+        for (std::size_t b = 0; b <= bucketCount; ++b)
+        {
+            cumulative += buckets[b];
+            text += name;
+            text += "_bucket{";
+            text += labels;
+            text += labels.empty() ? "le=\"" : ",le=\"";
+            if (b < bucketCount)
+            {
+                appendNumber(text, bounds[b]);
+            }
+            else
+            {
+                text += "+Inf";
+            }
+            text += "\"} " + std::to_string(cumulative) + '\n';
+        }
+        std::string braced = labels.empty() ? "" : "{" + labels + "}";
+        text += std::string(name) + "_sum" + braced + ' ';
+        appendNumber(text, sum);
+        text += '\n';
+        text += std::string(name) + "_count" + braced + ' ' + std::to_string(cumulative) + '\n';
+    }
+}
+
+#if DUNGEON_METRICS
+
+MetricsSpan::MetricsSpan(GameMetrics &metrics, MetricsHandler handler)
+    : metrics(metrics.timing ? &metrics : nullptr), handler(handler), start(0), waitedAtStart(metrics.waited)
+{
+    metrics.turns[handlerIndex(handler)]++;
+    if (this->metrics)
+    {
+        start = nowNs();
+    }
+}
+
+MetricsSpan::~MetricsSpan()
+{
+    if (metrics)
+    {
+        std::uint64_t waited = metrics->waited - waitedAtStart;
+        std::uint64_t compute = nowNs() - start - waited;
+        MetricsShard &shard = localShard();
+        shard.compute[handlerIndex(handler)].observe(latencyBucket(compute), compute);
+        shard.inputWait[handlerIndex(handler)].observe(latencyBucket(waited), waited);
+    }
+}
+
+GameMetrics::GameMetrics(bool timeEveryTurn)
+    : turns{}, transitions{}, combatTurnBuckets{}, combatTurnSum(0),
+      timeEveryTurn(timeEveryTurn), timing(false),
+      untilSample(timeEveryTurn ? 1 : localShard().nextSamplePhase++ % METRICS_TIMING_SAMPLE_EVERY + 1),
+      combatTurns(0), turnHandler(MetricsHandler::MAIN_MENU),
+      waited(0), waitStart(0), turnStart(0), turnWaitedAtStart(0) {}
+
+GameMetrics::~GameMetrics()
+{
+    flush();
+}
+
+void GameMetrics::flush()
+{
+    MetricsShard &shard = localShard();
+    for (std::size_t h = 0; h < METRICS_HANDLER_COUNT; ++h)
+    {
+        if (turns[h])
+        {
+            shard.turns[h].add(std::exchange(turns[h], 0));
+        }
+    }
+    for (std::size_t from = 0; from < METRICS_STATE_COUNT; ++from)
+    {
+        for (std::size_t to = 0; to < METRICS_STATE_COUNT; ++to)
+        {
+            if (transitions[from][to])
+            {
+                shard.transitions[from][to].add(std::exchange(transitions[from][to], 0));
+            }
+        }
+    }
+    shard.combatTurns.merge(combatTurnBuckets, std::exchange(combatTurnSum, 0));
+    std::fill(std::begin(combatTurnBuckets), std::end(combatTurnBuckets), 0);
+}
+
+void GameMetrics::startTiming(GameState state)
+{
+    // Timed turns are rare, which makes them the place to publish the counts
+    flush();
+    timing = true;
+    untilSample = timeEveryTurn ? 1 : METRICS_TIMING_SAMPLE_EVERY;
+    turnHandler = static_cast<MetricsHandler>(state);
+    turnWaitedAtStart = waited;
+    turnStart = nowNs();
+}
+
+void GameMetrics::finishTiming()
+{
+    std::uint64_t turnWaited = waited - turnWaitedAtStart;
+    std::uint64_t compute = nowNs() - turnStart - turnWaited;
+    MetricsShard &shard = localShard();
+    shard.compute[handlerIndex(turnHandler)].observe(latencyBucket(compute), compute);
+    shard.inputWait[handlerIndex(turnHandler)].observe(latencyBucket(turnWaited), turnWaited);
+    timing = false;
+}
+
+void GameMetrics::finishCombat()
+{
+    combatTurnBuckets[combatTurnBucket(combatTurns)]++;
+    combatTurnSum += static_cast<std::uint32_t>(combatTurns);
+    combatTurns = 0;
+}
+
+void GameMetrics::beginInputWait()
+{
+    if (timing)
+    {
+        waitStart = nowNs();
+    }
+}
+
+void GameMetrics::endInputWait()
+{
+    if (timing)
+    {
+        waited += nowNs() - waitStart;
+    }
+}
+
+#endif
+
+std::uint64_t totalStateTransitions()
+{
+    Totals total;
+    collect(total);
+    std::uint64_t sum = 0;
+    for (const auto &row : total.transitions)
+    {
+        for (std::uint64_t count : row)
+        {
+            sum += count;
+        }
+    }
+    return sum;
+}
+
+std::string renderMetrics(double transitionsPerSecond)
+{
+    std::string text;
+    if (!metricsCompiledIn())
+    {
+        text = "# dungeon_crawler was built with DUNGEON_METRICS=OFF\n";
+        return text;
+    }
+
+    Totals total;
+    collect(total);
+
+    double latencyBounds[LATENCY_BUCKETS];
+    for (std::size_t b = 0; b < LATENCY_BUCKETS; ++b)
+    {
+        latencyBounds[b] = double(FIRST_LATENCY_BOUND << b) * 1e-9;
+    }
+    double combatBounds[COMBAT_TURN_BUCKETS];
+    for (std::size_t b = 0; b < COMBAT_TURN_BUCKETS; ++b)
+    {
+        combatBounds[b] = COMBAT_TURN_BOUNDS[b];
+    }
+
+    appendHeader(text, "dungeon_turns_total", "counter", "Handler calls: turns per game state, plus nested handlers.");
+    for (std::size_t h = 0; h < METRICS_HANDLER_COUNT; ++h)
+    {
+        text += "dungeon_turns_total{handler=\"" + std::string(HANDLER_NAMES[h]) + "\"} " +
+                std::to_string(total.turns[h]) + '\n';
+    }
+
+    appendHeader(text, "dungeon_handler_compute_seconds", "histogram",
+                 "Time a handler spent working, input waits excluded. Headless turns are sampled.");
+    for (std::size_t h = 0; h < METRICS_HANDLER_COUNT; ++h)
+    {
+        appendHistogram(text, "dungeon_handler_compute_seconds", "handler=\"" + std::string(HANDLER_NAMES[h]) + "\"",
+                        total.compute[h], LATENCY_BUCKETS, latencyBounds, total.computeSum[h] * 1e-9);
+    }
+
+    appendHeader(text, "dungeon_handler_input_wait_seconds", "histogram",
+                 "Time a handler spent waiting for a line of input. Headless turns are sampled.");
+    for (std::size_t h = 0; h < METRICS_HANDLER_COUNT; ++h)
+    {
+        appendHistogram(text, "dungeon_handler_input_wait_seconds", "handler=\"" + std::string(HANDLER_NAMES[h]) + "\"",
+                        total.inputWait[h], LATENCY_BUCKETS, latencyBounds, total.inputWaitSum[h] * 1e-9);
+    }
+
+    appendHeader(text, "dungeon_state_transitions_total", "counter", "Game state changes.");
+    for (std::size_t from = 0; from < METRICS_STATE_COUNT; ++from)
+    {
+        for (std::size_t to = 0; to < METRICS_STATE_COUNT; ++to)
+        {
+            if (total.transitions[from][to] > 0)
+            {
+                text += "dungeon_state_transitions_total{from=\"" + std::string(HANDLER_NAMES[from]) +
+                        "\",to=\"" + HANDLER_NAMES[to] + "\"} " + std::to_string(total.transitions[from][to]) + '\n';
+            }
+        }
+    }
+
+    if (transitionsPerSecond >= 0.0)
+    {
+        appendHeader(text, "dungeon_state_transitions_per_second", "gauge",
+                     "State changes per second since the previous export.");
+        text += "dungeon_state_transitions_per_second ";
+        appendNumber(text, transitionsPerSecond);
+        text += '\n';
+    }
+
+    appendHeader(text, "dungeon_combat_turns", "histogram", "Turns each finished combat lasted.");
+    appendHistogram(text, "dungeon_combat_turns", "", total.combatTurns, COMBAT_TURN_BUCKETS, combatBounds,
+                    double(total.combatTurnsSum));
+
+    appendHeader(text, "dungeon_timing_sample_every", "gauge", "Headless turns are timed one in this many.");
+    text += "dungeon_timing_sample_every " + std::to_string(METRICS_TIMING_SAMPLE_EVERY) + '\n';
+    return text;
+}
+
+MetricsExporter::MetricsExporter(const std::string &path, std::chrono::milliseconds interval)
+    : path(path), interval(interval), stopping(false), lastTransitions(totalStateTransitions()),
+      lastWrite(std::chrono::steady_clock::now())
+{
+    writer = std::thread([this]
+                         { loop(); });
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stopRequested.notify_all();
+    writer.join();
+    writeOnce();
+}
+
+void MetricsExporter::loop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopRequested.wait_for(lock, interval, [this]
+                                   { return stopping; }))
+    {
+        lock.unlock();
+        writeOnce();
+        lock.lock();
+    }
+}
+
+void MetricsExporter::writeOnce()
+{
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - lastWrite).count();
+    std::uint64_t transitions = totalStateTransitions();
+    double rate = seconds > 0.0 ? (transitions - lastTransitions) / seconds : 0.0;
+    lastTransitions = transitions;
+    lastWrite = now;
+
+    std::string text = renderMetrics(rate);
+    std::string temporary = path + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+    if (!file)
+    {
+        return;
+    }
+    bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    written = std::fclose(file) == 0 && written;
+    if (!written)
+    {
+        std::remove(temporary.c_str());
+        return;
+    }
+#ifdef _WIN32
+    MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    std::rename(temporary.c_str(), path.c_str());
+#endif
+}
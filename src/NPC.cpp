@@ -1,75 +1,119 @@
 #include "NPC.h"
-#include <iostream>
-#include <random>
 
-NPC::NPC(const std::string &name, const std::string &emoji, bool isShopkeeper)
-    : name(name), emoji(emoji), isShopkeeper(isShopkeeper) {}
+void ShopCatalog::add(ItemId item, int price)
+{
+    for (ShopEntry &entry : entries)
+    {
+        if (entry.item == item)
+        {
+            entry.price = price;
+            return;
+        }
+    }
+    entries.push_back({item, price});
+}
+
+NPC::NPC(const std::string &name, const std::string &emoji, NPCRole role)
+    : name(name), emoji(emoji), role(role) {}
 
-std::string NPC::getName() const
+std::string_view NPC::getName() const
 {
     return name;
 }
 
-std::string NPC::getEmoji() const
+std::string_view NPC::getEmoji() const
 {
     return emoji;
 }
 
+NPCRole NPC::getRole() const
+{
+    return role;
+}
+
 bool NPC::getIsShopkeeper() const
 {
-    return isShopkeeper;
+    return role == NPCRole::SHOPKEEPER;
 }
 
-void NPC::addDialogue(const std::string &dialogue)
+void NPC::setDialogue(DialogueRange lines)
 {
-    dialogues.push_back(dialogue);
+    dialogue = lines;
 }
 
-std::string NPC::getRandomDialogue() const
+std::string_view NPC::getRandomDialogue(RandomStream &rng) const
 {
-    if (dialogues.empty())
+    if (dialogue.empty())
     {
         return "...";
     }
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distr(0, dialogues.size() - 1);
-
-    return dialogues[distr(gen)];
+    return DialogueCorpus::line(dialogue.first + rng.uniformInt(0, static_cast<int>(dialogue.count) - 1));
 }
 
-void NPC::addShopItem(const std::string &itemName, int price)
+void NPC::addShopItem(ItemId item, int price)
 {
-    shopItems[itemName] = price;
+    shop.add(item, price);
 }
 
-const std::map<std::string, int> &NPC::getShopItems() const
+const ShopCatalog &NPC::getShop() const
 {
-    return shopItems;
+    return shop;
 }
 
-void NPC::displayInfo() const
+void NPC::displayInfo(RandomStream &rng, GameOutput &out) const
 {
-    std::cout << emoji << " " << name;
+    out << emoji << " " << name;
 
-    if (isShopkeeper)
+    if (getIsShopkeeper())
     {
-        std::cout << " 🛒";
+        out << " 🛒";
     }
 
-    std::cout << std::endl;
+    out << '\n';
 
     // Display a random dialogue
-    std::cout << "\"" << getRandomDialogue() << "\"" << std::endl;
+    out << "\"" << getRandomDialogue(rng) << "\"\n";
 
     // If shopkeeper, display shop items
-    if (isShopkeeper && !shopItems.empty())
+    if (getIsShopkeeper() && !shop.empty())
     {
-        std::cout << "\n🛒 Shop Items:" << std::endl;
-        for (const auto &item : shopItems)
+        out << "\n🛒 Shop Items:\n";
+        for (const ShopEntry &entry : shop)
         {
-            std::cout << "  - " << item.first << ": " << item.second << " BDP" << std::endl;
+            out << "  - " << ItemRegistry::get(entry.item).name << ": " << entry.price << " BDP\n";
         }
     }
-}
\ No newline at end of file
+}
+
+NpcId NPCRegistry::add(NPC npc)
+{
+    if (npcs.size() >= NO_NPC)
+    {
+        return NO_NPC;
+    }
+    NpcId id = static_cast<NpcId>(npcs.size());
+    byRole[static_cast<std::size_t>(npc.getRole())].push_back(id);
+    npcs.push_back(std::move(npc));
+    return id;
+}
+
+const std::vector<NpcId> &NPCRegistry::withRole(NPCRole role) const
+{
+    return byRole[static_cast<std::size_t>(role)];
+}
+
+NpcId NPCRegistry::first(NPCRole role) const
+{
+    const std::vector<NpcId> &ids = withRole(role);
+    return ids.empty() ? NO_NPC : ids.front();
+}
+
+void NPCRegistry::clear()
+{
+    npcs.clear();
+    for (std::vector<NpcId> &ids : byRole)
+    {
+        ids.clear();
+    }
+}
@@ -0,0 +1,302 @@
+#include "Output.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const std::size_t WRITER_QUEUE_BYTES = 1 << 20;
+
+    // Write both spans with one system call where the platform allows it
+    void writeSpans(int fd, const SpscByteQueue::Spans &spans)
+    {
+#ifdef _WIN32
+        _write(fd, spans.first, static_cast<unsigned>(spans.firstSize));
+        if (spans.secondSize > 0)
+        {
+            _write(fd, spans.second, static_cast<unsigned>(spans.secondSize));
+        }
+#else
+        iovec parts[2] = {{const_cast<char *>(spans.first), spans.firstSize},
+                          {const_cast<char *>(spans.second), spans.secondSize}};
+        int count = spans.secondSize > 0 ? 2 : 1;
+        std::size_t remaining = spans.size();
+
+        while (remaining > 0)
+        {
+            ssize_t written = writev(fd, parts, count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue; // A signal arrived before anything was written
+                }
+                return; // Output is best effort; the game carries on without it
+            }
+            remaining -= static_cast<std::size_t>(written);
+
+            // Skip what was written and retry the rest
+            std::size_t skip = static_cast<std::size_t>(written);
+            for (iovec &part : parts)
+            {
+                std::size_t step = skip < part.iov_len ? skip : part.iov_len;
+                part.iov_base = static_cast<char *>(part.iov_base) + step;
+                part.iov_len -= step;
+                skip -= step;
+            }
+        }
+#endif
+    }
+}
+
+// Background thread that drains an SPSC queue into a file descriptor
+class AsyncWriter
+{
+private:
+    int fd;
+    bool ownsFd;
+    SpscByteQueue queue;
+    std::atomic<bool> stopping;
+    std::atomic<bool> sleeping;
+    std::atomic<std::size_t> bytesPushed;
+    std::atomic<std::size_t> bytesWritten;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread thread;
+
+    void wakeWriter()
+    {
+        if (sleeping.load())
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            wake.notify_one();
+        }
+    }
+
+    void writerLoop()
+    {
+        while (true)
+        {
+            SpscByteQueue::Spans spans = queue.readable();
+            if (spans.size() > 0)
+            {
+                writeSpans(fd, spans);
+                queue.consume(spans.size());
+                bytesWritten.fetch_add(spans.size());
+                continue;
+            }
+
+            if (stopping.load())
+            {
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            sleeping.store(true);
+            if (queue.empty() && !stopping.load())
+            {
+                wake.wait_for(lock, std::chrono::milliseconds(50));
+            }
+            sleeping.store(false);
+        }
+    }
+
+public:
+    AsyncWriter(int fd, bool ownsFd)
+        : fd(fd),
+          ownsFd(ownsFd),
+          queue(WRITER_QUEUE_BYTES),
+          stopping(false),
+          sleeping(false),
+          bytesPushed(0),
+          bytesWritten(0)
+    {
+        if (fd >= 0)
+        {
+            thread = std::thread(&AsyncWriter::writerLoop, this);
+        }
+    }
+
+    ~AsyncWriter()
+    {
+        if (thread.joinable())
+        {
+            stopping.store(true);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                wake.notify_one();
+            }
+            thread.join();
+        }
+        if (ownsFd && fd >= 0)
+        {
+#ifdef _WIN32
+            _close(fd);
+#else
+            close(fd);
+#endif
+        }
+    }
+
+    bool isOpen() const
+    {
+        return fd >= 0;
+    }
+
+    void push(std::string_view data)
+    {
+        if (fd < 0)
+        {
+            return;
+        }
+
+        // Only waits if the writer has fallen a whole queue behind
+        while (!data.empty())
+        {
+            std::size_t pushed = queue.tryPush(data.data(), data.size());
+            bytesPushed.fetch_add(pushed);
+            data.remove_prefix(pushed);
+            wakeWriter();
+            if (!data.empty())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void drain()
+    {
+        while (bytesWritten.load() != bytesPushed.load())
+        {
+            wakeWriter();
+            std::this_thread::yield();
+        }
+    }
+};
+
+void OutputSink::clearScreen()
+{
+    writeFrame("\033[H\033[2J\033[3J"); // Same sequence `clear` emits
+}
+
+void NullSink::writeFrame(std::string_view)
+{
+}
+
+void NullSink::clearScreen()
+{
+}
+
+bool NullSink::discardsOutput() const
+{
+    return true;
+}
+
+TerminalSink::TerminalSink()
+#ifdef _WIN32
+    : writer(std::make_unique<AsyncWriter>(1, false))
+#else
+    : writer(std::make_unique<AsyncWriter>(STDOUT_FILENO, false))
+#endif
+{
+#ifdef _WIN32
+    // Let the console interpret ANSI escape sequences
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(console, &mode))
+    {
+        SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+#endif
+}
+
+TerminalSink::~TerminalSink() = default;
+
+void TerminalSink::writeFrame(std::string_view frame)
+{
+    writer->push(frame);
+}
+
+void TerminalSink::drain()
+{
+    writer->drain();
+}
+
+AsyncFileSink::AsyncFileSink(const std::string &path)
+#ifdef _WIN32
+    : writer(std::make_unique<AsyncWriter>(_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, 0644), true))
+#else
+    : writer(std::make_unique<AsyncWriter>(open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644), true))
+#endif
+{
+}
+
+AsyncFileSink::~AsyncFileSink() = default;
+
+bool AsyncFileSink::isOpen() const
+{
+    return writer->isOpen();
+}
+
+void AsyncFileSink::writeFrame(std::string_view frame)
+{
+    writer->push(frame);
+}
+
+void AsyncFileSink::drain()
+{
+    writer->drain();
+}
+
+GameOutput::GameOutput(OutputSink &sink)
+    : sink(&sink), enabled(!sink.discardsOutput()) {}
+
+OutputSink &GameOutput::getSink() const
+{
+    return *sink;
+}
+
+void GameOutput::endFrame()
+{
+    if (!frame.empty())
+    {
+        sink->writeFrame(frame);
+        frame.clear();
+    }
+}
+
+void GameOutput::clearScreen()
+{
+    if (enabled)
+    {
+        endFrame();
+        sink->clearScreen();
+    }
+}
+
+void GameOutput::echoInput(std::string_view line)
+{
+    if (enabled)
+    {
+        sink->noteInput(line);
+    }
+}
+
+void GameOutput::drain()
+{
+    endFrame();
+    sink->drain();
+}
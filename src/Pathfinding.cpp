@@ -0,0 +1,342 @@
+#include "Pathfinding.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace
+{
+    const TilePos STEPS[4] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+    // Chunks a path may detour through beyond those spanning its two ends
+    const int PATH_WINDOW_MARGIN = 1;
+
+    // Largest window a query copies: about 17 KB of walls and nodes per chunk
+    const std::int64_t PATH_WINDOW_MAX_CHUNKS = 1024;
+
+    std::uint32_t manhattan(TilePos a, TilePos b)
+    {
+        return static_cast<std::uint32_t>(std::abs(a.x - b.x) + std::abs(a.y - b.y));
+    }
+}
+
+PathFinder::PathFinder(std::size_t maxExpanded)
+    : maxExpanded(maxExpanded) {}
+
+bool PathFinder::findPath(DungeonMap &map, TilePos start, TilePos goal, std::vector<TilePos> &path)
+{
+    path.clear();
+    open.clear();
+    lastExpanded = 0;
+    if (!map.isWalkable(start) || !map.isWalkable(goal))
+    {
+        return false;
+    }
+
+    // The window: chunks spanning both ends plus the margin, inside the level
+    ChunkCoord from = ChunkCoord::of(start);
+    ChunkCoord to = ChunkCoord::of(goal);
+    ChunkCoord first{std::min(from.x, to.x) - PATH_WINDOW_MARGIN, std::min(from.y, to.y) - PATH_WINDOW_MARGIN};
+    ChunkCoord last{std::max(from.x, to.x) + PATH_WINDOW_MARGIN, std::max(from.y, to.y) + PATH_WINDOW_MARGIN};
+    if (map.getExtent() > 0)
+    {
+        first = {std::max(first.x, 0), std::max(first.y, 0)};
+        last = {std::min(last.x, map.getExtent() - 1), std::min(last.y, map.getExtent() - 1)};
+    }
+    std::int64_t chunksWide = std::int64_t(last.x) - first.x + 1;
+    std::int64_t chunksHigh = std::int64_t(last.y) - first.y + 1;
+    if (chunksWide * chunksHigh > PATH_WINDOW_MAX_CHUNKS)
+    {
+        return false; // Its copy would take more than about 17 MB
+    }
+
+    origin = {first.x * CHUNK_SIZE, first.y * CHUNK_SIZE};
+    stride = static_cast<std::int32_t>(chunksWide) * CHUNK_SIZE + 2;
+    std::size_t cells = static_cast<std::size_t>(stride) * (chunksHigh * CHUNK_SIZE + 2);
+    walkable.assign(cells, 0);
+    if (nodes.size() < cells)
+    {
+        nodes.resize(cells, Node{0, 0, 0, 0});
+    }
+    if (++query == 0)
+    {
+        // Wrapped after 4 billion queries: forget every stamp
+        std::fill(nodes.begin(), nodes.end(), Node{0, 0, 0, 0});
+        query = 1;
+    }
+
+    for (int cy = 0; cy < chunksHigh; ++cy)
+    {
+        for (int cx = 0; cx < chunksWide; ++cx)
+        {
+            const DungeonChunk &chunk = map.chunk({first.x + cx, first.y + cy});
+            for (int y = 0; y < CHUNK_SIZE; ++y)
+            {
+                const Tile *tiles = chunk.tiles.data() + y * CHUNK_SIZE;
+                std::uint8_t *row = walkable.data() + cellOf({origin.x + cx * CHUNK_SIZE, origin.y + cy * CHUNK_SIZE + y});
+                for (int x = 0; x < CHUNK_SIZE; ++x)
+                {
+                    row[x] = tiles[x] != Tile::WALL;
+                }
+            }
+        }
+    }
+
+    const std::int32_t offsets[4] = {1, -1, stride, -stride};
+    std::uint32_t startCell = cellOf(start);
+    std::uint32_t goalCell = cellOf(goal);
+    nodes[startCell] = {0, startCell, query, 0};
+    open.push_back({manhattan(start, goal), startCell});
+
+    while (!open.empty())
+    {
+        std::pop_heap(open.begin(), open.end(), std::greater<>());
+        std::uint32_t current = open.back().cell;
+        open.pop_back();
+        if (nodes[current].closed == query)
+        {
+            continue;
+        }
+        if (current == goalCell)
+        {
+            for (std::uint32_t cell = current; cell != startCell; cell = nodes[cell].parent)
+            {
+                path.push_back(tileOf(cell));
+            }
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+        if (++lastExpanded > maxExpanded)
+        {
+            return false;
+        }
+        nodes[current].closed = query;
+
+        std::uint32_t cost = nodes[current].cost + 1;
+        for (std::int32_t offset : offsets)
+        {
+            std::uint32_t neighbour = current + offset;
+            Node &node = nodes[neighbour];
+            if (!walkable[neighbour] || (node.seen == query && (node.closed == query || cost >= node.cost)))
+            {
+                continue;
+            }
+            node.cost = cost;
+            node.parent = current;
+            node.seen = query;
+            open.push_back({cost + manhattan(tileOf(neighbour), goal), neighbour});
+            std::push_heap(open.begin(), open.end(), std::greater<>());
+        }
+    }
+    return false;
+}
+
+void FlowField::reset(DungeonMap &map, ChunkCoord first, int chunksWide, int chunksHigh)
+{
+    origin = {first.x * CHUNK_SIZE, first.y * CHUNK_SIZE};
+    width = chunksWide * CHUNK_SIZE;
+    height = chunksHigh * CHUNK_SIZE;
+    stride = width + 2;
+    std::size_t cells = static_cast<std::size_t>(stride) * (height + 2);
+    // A wall's distance stays 0, so a sweep never improves on it and needs no wall test
+    walkable.assign(cells, 0);
+    distance.assign(cells, 0);
+    owner.assign(cells, NO_GOAL);
+    goals.clear();
+    live.clear();
+
+    // Copy walls a chunk row at a time rather than looking up every tile
+    for (int cy = 0; cy < chunksHigh; ++cy)
+    {
+        for (int cx = 0; cx < chunksWide; ++cx)
+        {
+            ChunkCoord coord{first.x + cx, first.y + cy};
+            if (!map.contains(coord))
+            {
+                continue;
+            }
+            const DungeonChunk &chunk = map.chunk(coord);
+            for (int y = 0; y < CHUNK_SIZE; ++y)
+            {
+                std::uint32_t start = cellOf(cx * CHUNK_SIZE, cy * CHUNK_SIZE + y);
+                const Tile *tiles = chunk.tiles.data() + y * CHUNK_SIZE;
+                std::uint8_t *open = walkable.data() + start;
+                std::uint32_t *steps = distance.data() + start;
+                for (int x = 0; x < CHUNK_SIZE; ++x)
+                {
+                    open[x] = tiles[x] != Tile::WALL;
+                    steps[x] = open[x] ? UNREACHABLE : 0;
+                }
+            }
+        }
+    }
+}
+
+bool FlowField::indexOf(TilePos tile, std::uint32_t &cell) const
+{
+    int x = tile.x - origin.x;
+    int y = tile.y - origin.y;
+    if (x < 0 || y < 0 || x >= width || y >= height)
+    {
+        return false;
+    }
+    cell = cellOf(x, y);
+    return true;
+}
+
+bool FlowField::covers(TilePos tile) const
+{
+    std::uint32_t cell;
+    return indexOf(tile, cell);
+}
+
+void FlowField::addGoal(std::uint16_t id, TilePos tile)
+{
+    if (id >= goals.size())
+    {
+        goals.resize(id + 1);
+        live.resize(id + 1, 0);
+    }
+    goals[id] = tile;
+    live[id] = 1;
+}
+
+void FlowField::seedLiveGoals()
+{
+    for (std::size_t id = 0; id < goals.size(); ++id)
+    {
+        std::uint32_t cell;
+        if (live[id] && indexOf(goals[id], cell) && walkable[cell] && owner[cell] == NO_GOAL)
+        {
+            distance[cell] = 0;
+            owner[cell] = static_cast<std::uint16_t>(id);
+            queue.push_back({0, cell});
+        }
+    }
+}
+
+void FlowField::build()
+{
+    queue.clear();
+    seedLiveGoals();
+    sweep(0);
+}
+
+// Breadth-first from the queue, which is sorted by distance. Every step costs
+// the same, so popping whichever is nearer, the next queued entry or the
+// oldest tile reached, visits tiles in Dijkstra order without a heap.
+void FlowField::sweep(std::size_t next)
+{
+    const std::int32_t offsets[4] = {1, -1, stride, -stride};
+    region.clear();
+    std::size_t head = 0;
+    while (next < queue.size() || head < region.size())
+    {
+        std::uint32_t cell;
+        if (head == region.size() ||
+            (next < queue.size() && queue[next].distance <= distance[region[head]]))
+        {
+            cell = queue[next++].cell;
+        }
+        else
+        {
+            cell = region[head++];
+        }
+
+        std::uint32_t reached = distance[cell] + 1;
+        for (std::int32_t offset : offsets)
+        {
+            std::uint32_t neighbour = cell + offset;
+            if (reached < distance[neighbour])
+            {
+                distance[neighbour] = reached;
+                owner[neighbour] = owner[cell];
+                region.push_back(neighbour);
+            }
+        }
+    }
+}
+
+void FlowField::removeGoal(std::uint16_t id)
+{
+    std::uint32_t start;
+    if (id >= goals.size() || !live[id])
+    {
+        return;
+    }
+    live[id] = 0;
+    if (!indexOf(goals[id], start) || owner[start] != id)
+    {
+        return; // Never reached anything, or shares its tile with a goal that owns it
+    }
+
+    // The tiles nearest to this goal form one connected region around it
+    const std::int32_t offsets[4] = {1, -1, stride, -stride};
+    std::vector<std::uint32_t> &lost = region;
+    lost.clear();
+    lost.push_back(start);
+    distance[start] = UNREACHABLE;
+    owner[start] = NO_GOAL;
+    for (std::size_t head = 0; head < lost.size(); ++head)
+    {
+        for (std::int32_t offset : offsets)
+        {
+            std::uint32_t neighbour = lost[head] + offset;
+            if (owner[neighbour] == id)
+            {
+                distance[neighbour] = UNREACHABLE;
+                owner[neighbour] = NO_GOAL;
+                lost.push_back(neighbour);
+            }
+        }
+    }
+
+    // Refill the region from its border with the other goals' regions, and
+    // from any live goal standing inside it
+    queue.clear();
+    for (std::uint32_t cell : lost)
+    {
+        for (std::int32_t offset : offsets)
+        {
+            std::uint32_t neighbour = cell + offset;
+            if (owner[neighbour] != NO_GOAL)
+            {
+                queue.push_back({distance[neighbour], neighbour});
+            }
+        }
+    }
+    seedLiveGoals();
+    std::sort(queue.begin(), queue.end(), [](const QueueEntry &a, const QueueEntry &b)
+              { return a.distance != b.distance ? a.distance < b.distance : a.cell < b.cell; });
+    sweep(0);
+}
+
+std::uint32_t FlowField::distanceAt(TilePos tile) const
+{
+    std::uint32_t cell;
+    return indexOf(tile, cell) && walkable[cell] ? distance[cell] : UNREACHABLE;
+}
+
+std::uint16_t FlowField::nearestGoal(TilePos tile) const
+{
+    std::uint32_t cell;
+    return indexOf(tile, cell) ? owner[cell] : NO_GOAL;
+}
+
+TilePos FlowField::next(TilePos tile) const
+{
+    std::uint32_t cell;
+    if (!indexOf(tile, cell) || distance[cell] == 0 || distance[cell] == UNREACHABLE)
+    {
+        return tile;
+    }
+    for (TilePos step : STEPS)
+    {
+        TilePos neighbour{tile.x + step.x, tile.y + step.y};
+        std::uint32_t other;
+        if (indexOf(neighbour, other) && walkable[other] && distance[other] < distance[cell])
+        {
+            return neighbour;
+        }
+    }
+    return tile;
+}
@@ -1,9 +1,11 @@
 #include "Player.h"
-#include <iostream>
-#include <algorithm>
+#include "Balance.h"
+
+// Entity plus progress and a flat count array: two cache lines on 64-bit targets
+static_assert(sizeof(void *) != 8 || sizeof(Player) <= 128, "Player outgrew two cache lines");
 
 Player::Player(const std::string &name)
-    : Entity(name, 100, 10, 5), level(1), experience(0), experienceToNextLevel(100), bdp(0) {}
+    : Entity(name, 100, 10, 5), level(1), experience(0), experienceToNextLevel(100), bdp(0), itemCounts{} {}
 
 int Player::getLevel() const
 {
@@ -25,171 +27,214 @@ int Player::getBDP() const
     return bdp;
 }
 
-const std::vector<Item> &Player::getInventory() const
+int Player::getItemCount(ItemId id) const
+{
+    return ItemRegistry::isValid(id) ? itemCounts[id] : 0;
+}
+
+const std::array<std::uint16_t, MAX_ITEM_TYPES> &Player::getItemCounts() const
 {
-    return inventory;
+    return itemCounts;
 }
 
-int Player::getItemCount(const std::string &itemName) const
+bool Player::hasItems() const
 {
-    auto it = itemCounts.find(itemName);
-    if (it != itemCounts.end())
+    for (std::uint16_t count : itemCounts)
     {
-        return it->second;
+        if (count > 0)
+        {
+            return true;
+        }
     }
-    return 0;
+    return false;
 }
 
-void Player::gainExperience(int amount)
+int Player::getItemSlot(ItemId id) const
+{
+    if (getItemCount(id) == 0)
+    {
+        return 0;
+    }
+
+    int slot = 1;
+    for (ItemId other = 0; other < id; ++other)
+    {
+        if (itemCounts[other] > 0)
+        {
+            slot++;
+        }
+    }
+    return slot;
+}
+
+ItemId Player::getItemAtSlot(int slot) const
+{
+    for (std::size_t id = 0; id < ItemRegistry::size(); ++id)
+    {
+        if (itemCounts[id] > 0 && --slot == 0)
+        {
+            return static_cast<ItemId>(id);
+        }
+    }
+    return NO_ITEM;
+}
+
+void Player::gainExperience(int amount, GameOutput &out)
 {
     experience += amount;
-    std::cout << "You gained " << amount << " experience! 📈" << std::endl;
+    out << "You gained " << amount << " experience! 📈\n";
 
     // Check if player can level up
     if (experience >= experienceToNextLevel)
     {
-        levelUp();
+        levelUp(out);
     }
 }
 
-void Player::levelUp()
+void Player::levelUp(GameOutput &out)
 {
+    const BalanceParams &balance = Balance::get();
     level++;
     experience -= experienceToNextLevel;
-    experienceToNextLevel = 100 * level; // Increase XP needed for next level
+    experienceToNextLevel = balance.experiencePerLevel * level; // Increase XP needed for next level
 
     // Increase stats
-    maxHealth += 20;
+    maxHealth += balance.levelUpHealth;
     health = maxHealth; // Fully heal on level up
-    attack += 5;
-    defense += 2;
-
-    std::cout << "\n🎉 LEVEL UP! 🎉" << std::endl;
-    std::cout << "You are now level " << level << "!" << std::endl;
-    std::cout << "Your stats have increased!" << std::endl;
-    displayStats();
-    std::cout << std::endl;
+    attack += balance.levelUpAttack;
+    defense += balance.levelUpDefense;
+
+    out << "\n🎉 LEVEL UP! 🎉\n";
+    out << "You are now level " << level << "!\n";
+    out << "Your stats have increased!\n";
+    displayStats(out);
+    out << '\n';
 }
 
-void Player::earnBDP(int amount)
+void Player::earnBDP(int amount, GameOutput &out)
 {
     bdp += amount;
-    std::cout << "You earned " << amount << " BDP! 💰" << std::endl;
+    out << "You earned " << amount << " BDP! 💰\n";
 }
 
-void Player::spendBDP(int amount)
+bool Player::spendBDP(int amount, GameOutput &out)
 {
     if (bdp >= amount)
     {
         bdp -= amount;
-        std::cout << "You spent " << amount << " BDP. Remaining: " << bdp << " BDP 💸" << std::endl;
+        out << "You spent " << amount << " BDP. Remaining: " << bdp << " BDP 💸\n";
+        return true;
     }
     else
     {
-        std::cout << "Not enough BDP! You need " << amount << " but only have " << bdp << " 😢" << std::endl;
+        out << "Not enough BDP! You need " << amount << " but only have " << bdp << " 😢\n";
+        return false;
     }
 }
 
-void Player::addItem(const Item &item)
+void Player::addItem(ItemId id, GameOutput &out)
 {
-    // Add item to inventory
-    inventory.push_back(item);
+    if (!ItemRegistry::isValid(id))
+    {
+        return;
+    }
 
-    // Update item count
-    itemCounts[item.name]++;
+    if (itemCounts[id] < UINT16_MAX)
+    {
+        itemCounts[id]++;
+    }
 
-    std::cout << "Added " << item.emoji << " " << item.name << " to your inventory!" << std::endl;
+    const ItemInfo &item = ItemRegistry::get(id);
+    out << "Added " << item.emoji << " " << item.name << " to your inventory!\n";
 }
 
-bool Player::useItem(const std::string &itemName)
+bool Player::useItem(ItemId id, GameOutput &out)
 {
     // Check if player has the item
-    if (getItemCount(itemName) <= 0)
+    if (getItemCount(id) <= 0)
     {
-        std::cout << "You don't have any " << itemName << "!" << std::endl;
+        out << "You don't have any " << (ItemRegistry::isValid(id) ? ItemRegistry::get(id).name : "such item") << "!\n";
         return false;
     }
 
-    // Find the item in inventory
-    auto it = std::find_if(inventory.begin(), inventory.end(),
-                           [&itemName](const Item &item)
-                           { return item.name == itemName; });
+    // Apply item effects
+    const ItemInfo &item = ItemRegistry::get(id);
+    switch (item.effect)
+    {
+    case ItemEffect::HEAL_PERCENT:
+        heal(getMaxHealth() * item.amount / 100, out);
+        break;
+    case ItemEffect::ATTACK_BONUS:
+        attack += item.amount;
+        out << "Your attack power has increased by " << item.amount << "! 💪\n";
+        break;
+    case ItemEffect::DEFENSE_BONUS:
+        defense += item.amount;
+        out << "Your defense has increased by " << item.amount << "! 🛡️\n";
+        break;
+    case ItemEffect::NONE:
+        break;
+    }
 
-    if (it != inventory.end())
+    // Remove item if consumable
+    if (item.isConsumable)
     {
-        // Apply item effects
-        if (itemName == "Health Potion")
-        {
-            int healAmount = getMaxHealth() / 2; // Heal 50% of max health
-            heal(healAmount);
-        }
-        else if (itemName == "Attack Boost")
-        {
-            attack += 5;
-            std::cout << "Your attack power has increased by 5! 💪" << std::endl;
-        }
-        else if (itemName == "Defense Boost")
-        {
-            defense += 3;
-            std::cout << "Your defense has increased by 3! 🛡️" << std::endl;
-        }
+        itemCounts[id]--;
+    }
 
-        // Remove item if consumable
-        if (it->isConsumable)
-        {
-            // Decrease item count
-            itemCounts[itemName]--;
-
-            // Remove from inventory if count is 0
-            if (itemCounts[itemName] <= 0)
-            {
-                inventory.erase(it);
-                itemCounts.erase(itemName);
-            }
-        }
+    return true;
+}
 
-        return true;
-    }
+void Player::restoreStats(int health, int maxHealth, int attack, int defense,
+                          int level, int experience, int experienceToNextLevel, int bdp)
+{
+    this->health = health;
+    this->maxHealth = maxHealth;
+    this->attack = attack;
+    this->defense = defense;
+    this->level = level;
+    this->experience = experience;
+    this->experienceToNextLevel = experienceToNextLevel;
+    this->bdp = bdp;
+}
 
-    return false;
+void Player::restoreInventory(const std::array<std::uint16_t, MAX_ITEM_TYPES> &counts)
+{
+    itemCounts = counts;
 }
 
-void Player::displayStats() const
+void Player::displayStats(GameOutput &out) const
 {
-    std::cout << "👤 " << name << " (Level " << level << ")" << std::endl;
-    std::cout << "❤️ Health: " << health << "/" << maxHealth << std::endl;
-    std::cout << "⚔️ Attack: " << attack << std::endl;
-    std::cout << "🛡️ Defense: " << defense << std::endl;
-    std::cout << "📊 Experience: " << experience << "/" << experienceToNextLevel << std::endl;
-    std::cout << "💰 BDP: " << bdp << std::endl;
+    out << "👤 " << name << " (Level " << level << ")\n";
+    out << "❤️ Health: " << health << "/" << maxHealth << '\n';
+    out << "⚔️ Attack: " << attack << '\n';
+    out << "🛡️ Defense: " << defense << '\n';
+    out << "📊 Experience: " << experience << "/" << experienceToNextLevel << '\n';
+    out << "💰 BDP: " << bdp << '\n';
 }
 
-void Player::displayInventory() const
+void Player::displayInventory(GameOutput &out) const
 {
-    std::cout << "\n🎒 INVENTORY 🎒" << std::endl;
-    std::cout << "==============" << std::endl;
+    out << "\n🎒 INVENTORY 🎒\n";
+    out << "==============\n";
 
-    if (inventory.empty())
+    if (!hasItems())
     {
-        std::cout << "Your inventory is empty!" << std::endl;
+        out << "Your inventory is empty!\n";
         return;
     }
 
-    // Group items by name and display count
-    for (const auto &pair : itemCounts)
+    // Numbered the same way as the use-item menu
+    int slot = 1;
+    for (std::size_t id = 0; id < ItemRegistry::size(); ++id)
     {
-        const std::string &itemName = pair.first;
-        int count = pair.second;
-
-        // Find the item to get its emoji
-        auto it = std::find_if(inventory.begin(), inventory.end(),
-                               [&itemName](const Item &item)
-                               { return item.name == itemName; });
-
-        if (it != inventory.end())
+        if (itemCounts[id] == 0)
         {
-            std::cout << it->emoji << " " << itemName << " x" << count << std::endl;
-            std::cout << "   " << it->description << std::endl;
+            continue;
         }
+        const ItemInfo &item = ItemRegistry::get(static_cast<ItemId>(id));
+        out << slot << ". " << item.emoji << " " << item.name << " x" << itemCounts[id] << '\n';
+        out << "   " << item.description << '\n';
+        slot++;
     }
-}
\ No newline at end of file
+}
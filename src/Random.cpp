@@ -0,0 +1,39 @@
+#include "Random.h"
+#include <random>
+
+namespace
+{
+    // Distinct salts so every subsystem gets its own stream key
+    const std::uint64_t COMBAT_STREAM = 0x636f6d626174ULL;
+    const std::uint64_t LOOT_STREAM = 0x6c6f6f74ULL;
+    const std::uint64_t SPAWNING_STREAM = 0x737061776eULL;
+    const std::uint64_t DIALOGUE_STREAM = 0x6469616c6f67ULL;
+
+    std::uint64_t streamKey(std::uint64_t seed, std::uint64_t salt)
+    {
+        return RandomStream::mix(RandomStream::mix(seed) ^ salt);
+    }
+}
+
+RandomService::RandomService(std::uint64_t seed)
+    : seed(seed),
+      combat(streamKey(seed, COMBAT_STREAM)),
+      loot(streamKey(seed, LOOT_STREAM)),
+      spawning(streamKey(seed, SPAWNING_STREAM)),
+      dialogue(streamKey(seed, DIALOGUE_STREAM)) {}
+
+std::uint64_t RandomService::getSeed() const
+{
+    return seed;
+}
+
+std::uint64_t RandomService::deriveSeed(std::uint64_t seed, std::uint64_t index)
+{
+    return RandomStream(RandomStream::mix(seed), index).next();
+}
+
+std::uint64_t RandomService::entropySeed()
+{
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+}
@@ -0,0 +1,297 @@
+#include "Replay.h"
+#include "Balance.h"
+#include "Dialogue.h"
+#include "EnemyArchetype.h"
+#include "Game.h"
+#include <algorithm>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<RecordingHeader> && sizeof(RecordingHeader) % 8 == 0,
+              "recording header must be plain data and keep records 8-byte aligned");
+static_assert(std::is_trivially_copyable_v<RecordHeader> && sizeof(RecordHeader) % 8 == 0,
+              "record headers must be plain data and keep payloads 8-byte aligned");
+
+namespace
+{
+    std::size_t padded(std::size_t size)
+    {
+        return (size + 7) & ~std::size_t(7);
+    }
+
+    class Fnv1a
+    {
+    private:
+        std::uint64_t hash = 14695981039346656037ULL;
+
+    public:
+        void add(std::string_view text)
+        {
+            add(static_cast<std::int32_t>(text.size())); // Keeps "ab","c" apart from "a","bc"
+            for (char c : text)
+            {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        void add(std::int32_t value)
+        {
+            for (int shift = 0; shift < 32; shift += 8)
+            {
+                hash ^= static_cast<std::uint8_t>(value >> shift);
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        std::uint64_t get() const { return hash; }
+    };
+
+    // Feeds the recorded lines back to the game from a given position
+    class ReplayInput : public InputSource
+    {
+    private:
+        const std::vector<std::string_view> &lines;
+        std::size_t next;
+
+    public:
+        ReplayInput(const std::vector<std::string_view> &lines, std::size_t first)
+            : lines(lines), next(first) {}
+
+        void restart(std::size_t first)
+        {
+            next = first;
+        }
+
+        InputStatus readLine(std::string &line) override
+        {
+            if (next >= lines.size())
+            {
+                return InputStatus::CLOSED;
+            }
+            line.assign(lines[next++]);
+            return InputStatus::LINE;
+        }
+    };
+}
+
+std::uint64_t balanceFingerprint()
+{
+    Fnv1a hash;
+    const BalanceParams &params = Balance::get();
+    for (std::size_t i = 0; i < Balance::fieldCount(); ++i)
+    {
+        hash.add(Balance::fields()[i].name);
+        hash.add(params.*Balance::fields()[i].member);
+    }
+    return hash.get();
+}
+
+std::uint64_t enemiesFingerprint()
+{
+    Fnv1a hash;
+    for (std::size_t id = 0; id < EnemyRegistry::size(); ++id)
+    {
+        const EnemyArchetype &type = EnemyRegistry::get(static_cast<EnemyArchetypeId>(id));
+        hash.add(type.name);
+        hash.add(type.emoji);
+        for (const StatScaling &stat : {type.health, type.attack, type.defense, type.experienceReward, type.bdpReward})
+        {
+            hash.add(stat.base);
+            hash.add(stat.perLevel);
+        }
+        hash.add(type.isBoss ? 1 : 0);
+    }
+    return hash.get();
+}
+
+// Lines in corpus order; pool names only label runs of them
+std::uint64_t dialogueFingerprint()
+{
+    Fnv1a hash;
+    for (std::size_t i = 0; i < DialogueCorpus::lineCount(); ++i)
+    {
+        hash.add(DialogueCorpus::line(static_cast<std::uint32_t>(i)));
+    }
+    return hash.get();
+}
+
+SessionRecorder::SessionRecorder(const std::string &path, std::uint64_t seed, int checkpointEvery)
+    : file(path, std::ios::binary | std::ios::trunc),
+      checkpointEvery(checkpointEvery),
+      nextCheckpoint(checkpointEvery),
+      linesRecorded(0)
+{
+    RecordingHeader header{RECORDING_MAGIC, RECORDING_VERSION, sizeof(RecordingHeader), seed,
+                           balanceFingerprint(), enemiesFingerprint(), dialogueFingerprint()};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.flush();
+}
+
+bool SessionRecorder::isOpen() const
+{
+    return file.good();
+}
+
+void SessionRecorder::writeRecord(RecordKind kind, int turn, const char *payload, std::size_t size)
+{
+    static const char padding[8] = {};
+    RecordHeader header{kind, static_cast<std::uint32_t>(turn), linesRecorded, static_cast<std::uint32_t>(size)};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(payload, static_cast<std::streamsize>(size));
+    file.write(padding, static_cast<std::streamsize>(padded(size) - size));
+    file.flush();
+}
+
+void SessionRecorder::recordLine(int turn, std::string_view line)
+{
+    writeRecord(RecordKind::INPUT_LINE, turn, line.data(), line.size());
+    linesRecorded++;
+}
+
+void SessionRecorder::turnBoundary(const Game &game)
+{
+    if (checkpointEvery <= 0 || game.getTurnCount() < nextCheckpoint)
+    {
+        return;
+    }
+    game.saveSnapshot(snapshot);
+    writeRecord(RecordKind::CHECKPOINT, game.getTurnCount(), snapshot.data(), snapshot.size());
+    nextCheckpoint = game.getTurnCount() + checkpointEvery;
+}
+
+SessionReplay::SessionReplay() : seed(0) {}
+
+SessionReplay::~SessionReplay() = default;
+
+bool SessionReplay::load(const std::string &path, std::string &error)
+{
+    auto mapped = std::make_unique<MappedFile>(path);
+    if (!mapped->isOpen())
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    const char *data = mapped->getData();
+    std::size_t size = mapped->getSize();
+    RecordingHeader header;
+    if (size < sizeof(header))
+    {
+        error = path + " is not a recording";
+        return false;
+    }
+    std::copy(data, data + sizeof(header), reinterpret_cast<char *>(&header));
+    if (header.magic != RECORDING_MAGIC || header.version != RECORDING_VERSION ||
+        header.headerSize != sizeof(RecordingHeader))
+    {
+        error = path + " is not a recording this version can read";
+        return false;
+    }
+    // Under other rules the same input plays a different game
+    if (header.balanceFingerprint != balanceFingerprint())
+    {
+        error = path + " was recorded with other balance parameters (pass the same --balance file)";
+        return false;
+    }
+    if (header.enemiesFingerprint != enemiesFingerprint())
+    {
+        error = path + " was recorded with other enemy types (pass the same --enemies file)";
+        return false;
+    }
+    if (header.dialogueFingerprint != dialogueFingerprint())
+    {
+        error = path + " was recorded with other dialogue (pass the same --dialogue file)";
+        return false;
+    }
+
+    std::vector<std::string_view> loadedLines;
+    std::vector<Checkpoint> loadedCheckpoints;
+    std::size_t offset = sizeof(RecordingHeader);
+    while (offset + sizeof(RecordHeader) <= size)
+    {
+        RecordHeader record;
+        std::copy(data + offset, data + offset + sizeof(record), reinterpret_cast<char *>(&record));
+        const char *payload = data + offset + sizeof(record);
+        if (record.size > size - offset - sizeof(record))
+        {
+            break; // Cut off mid-record by a crash; keep what came before
+        }
+
+        if (record.kind == RecordKind::INPUT_LINE)
+        {
+            loadedLines.emplace_back(payload, record.size);
+        }
+        else if (record.kind == RecordKind::CHECKPOINT)
+        {
+            SnapshotView snapshot(payload, record.size);
+            if (snapshot.isValid() && record.inputIndex <= loadedLines.size())
+            {
+                loadedCheckpoints.push_back({static_cast<int>(record.turn), record.inputIndex, snapshot});
+            }
+        }
+        else
+        {
+            error = path + " has an unknown record kind";
+            return false;
+        }
+        offset += sizeof(record) + padded(record.size);
+    }
+
+    file = std::move(mapped);
+    seed = header.seed;
+    lines = std::move(loadedLines);
+    checkpoints = std::move(loadedCheckpoints);
+    return true;
+}
+
+std::uint64_t SessionReplay::getSeed() const
+{
+    return seed;
+}
+
+std::size_t SessionReplay::lineCount() const
+{
+    return lines.size();
+}
+
+std::size_t SessionReplay::checkpointCount() const
+{
+    return checkpoints.size();
+}
+
+ReplayedSession SessionReplay::seek(int turn) const
+{
+    // Nothing is printed and no pause waits, so the session runs at full speed
+    ReplayedSession session;
+    session.sink = std::make_unique<NullSink>();
+    auto input = std::make_unique<ReplayInput>(lines, 0);
+    ReplayInput &replayInput = *input;
+    session.input = std::move(input);
+    session.game = std::make_unique<Game>(nullptr, seed, session.sink.get(), session.input.get());
+    Game &game = *session.game;
+
+    // Resume from the latest checkpoint at or before the target turn. One the
+    // game rejects leaves it untouched, so the next earlier one is tried, and
+    // without any the session plays from turn 0 with the first input line.
+    if (turn >= 0)
+    {
+        for (auto checkpoint = checkpoints.rbegin(); checkpoint != checkpoints.rend(); ++checkpoint)
+        {
+            if (checkpoint->turn > turn)
+            {
+                continue;
+            }
+            if (game.loadSnapshot(checkpoint->snapshot))
+            {
+                replayInput.restart(checkpoint->inputIndex);
+                break;
+            }
+            session.damagedCheckpoints++;
+        }
+    }
+
+    while ((turn < 0 || game.getTurnCount() < turn) && game.step())
+    {
+    }
+    return session;
+}
@@ -0,0 +1,192 @@
+#include "SessionHost.h"
+
+SessionHost::SessionHost(const SessionHostConfig &config)
+    : config(config), pool(config.threads), finishedCount(0) {}
+
+SessionHost::~SessionHost()
+{
+    requestExit();
+    wait();
+    pool.wait();
+}
+
+SessionHost::Session &SessionHost::at(SessionId id) const
+{
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    return *sessions.at(id);
+}
+
+SessionHost::SessionId SessionHost::add(std::unique_ptr<Session> session)
+{
+    Session &added = *session;
+    added.parked.store(false);
+    added.finished.store(false);
+
+    SessionId id;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        id = sessions.size();
+        sessions.push_back(std::move(session));
+    }
+
+    if (added.input)
+    {
+        added.input->setListener([this, &added]
+                                 { wake(added); });
+    }
+    pool.submit([this, &added]
+                { runSlice(added); });
+    return id;
+}
+
+SessionHost::SessionId SessionHost::addPlayerSession(std::unique_ptr<OutputSink> output, std::uint64_t seed)
+{
+    auto session = std::make_unique<Session>();
+    session->input = std::make_unique<QueueInput>();
+    session->output = std::move(output);
+    session->game = std::make_unique<Game>(nullptr, seed, session->output.get(), session->input.get());
+    session->game->setEventFile(config.events);
+    return add(std::move(session));
+}
+
+SessionHost::SessionId SessionHost::addBotSession(std::unique_ptr<DecisionPolicy> policy, std::uint64_t seed,
+                                                  std::unique_ptr<OutputSink> output)
+{
+    auto session = std::make_unique<Session>();
+    session->output = output ? std::move(output) : std::make_unique<NullSink>();
+    session->policy = std::move(policy);
+    session->game = std::make_unique<Game>(session->policy.get(), seed, session->output.get());
+    session->game->setEventFile(config.events);
+    return add(std::move(session));
+}
+
+void SessionHost::runSlice(Session &session)
+{
+    Game &game = *session.game;
+
+    for (int i = 0; i < config.stepsPerSlice; ++i)
+    {
+        bool running = game.step();
+        if (running && session.policy && config.maxTurnsPerSession > 0 &&
+            game.getTurnCount() >= config.maxTurnsPerSession)
+        {
+            running = false;
+        }
+        if (!running)
+        {
+            finish(session);
+            return;
+        }
+
+        if (game.isWaitingForInput() && !session.input->hasInput())
+        {
+            // Park, then look again: a line pushed in between must not be missed
+            session.parked.store(true);
+            if (!session.input->hasInput() || !session.parked.exchange(false))
+            {
+                return;
+            }
+        }
+    }
+
+    // Let other sessions have the worker
+    pool.submit([this, &session]
+                { runSlice(session); });
+}
+
+void SessionHost::finish(Session &session)
+{
+    Game &game = *session.game;
+    session.result.state = game.getState();
+    session.result.playerAlive = game.getPlayer().isAlive();
+    session.result.turns = game.getTurnCount();
+    session.result.dungeonLevel = game.getCurrentDungeonLevel();
+    session.result.finished = true;
+    session.output->drain();
+    session.finished.store(true);
+
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    finishedCount.fetch_add(1);
+    allFinished.notify_all();
+}
+
+void SessionHost::wake(Session &session)
+{
+    if (session.parked.exchange(false))
+    {
+        pool.submit([this, &session]
+                    { runSlice(session); });
+    }
+}
+
+void SessionHost::sendInput(SessionId id, std::string line)
+{
+    Session &session = at(id);
+    if (session.input && !session.finished.load())
+    {
+        session.input->push(std::move(line));
+    }
+}
+
+void SessionHost::closeInput(SessionId id)
+{
+    Session &session = at(id);
+    if (session.input)
+    {
+        session.input->close();
+    }
+}
+
+void SessionHost::requestExit()
+{
+    std::vector<Session *> all;
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        for (const std::unique_ptr<Session> &session : sessions)
+        {
+            all.push_back(session.get());
+        }
+    }
+
+    for (Session *session : all)
+    {
+        session->game->requestExit();
+        if (session->input)
+        {
+            session->input->close(); // Wakes a parked session and unblocks a waiting read
+        }
+    }
+}
+
+void SessionHost::wait()
+{
+    std::unique_lock<std::mutex> lock(sessionsMutex);
+    allFinished.wait(lock, [this]
+                     { return finishedCount.load() == sessions.size(); });
+}
+
+std::size_t SessionHost::sessionCount() const
+{
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    return sessions.size();
+}
+
+std::size_t SessionHost::finishedSessions() const
+{
+    return finishedCount.load();
+}
+
+std::size_t SessionHost::threadCount() const
+{
+    return pool.size();
+}
+
+SessionResult SessionHost::result(SessionId id) const
+{
+    Session &session = at(id);
+    if (!session.finished.load())
+    {
+        return SessionResult();
+    }
+    return session.result;
+}
@@ -0,0 +1,90 @@
+#include "Simulator.h"
+#include "Game.h"
+#include "CombatEvents.h"
+#include <chrono>
+#include <memory>
+
+double SimulationReport::winRate() const
+{
+    return runs > 0 ? static_cast<double>(victories) / runs : 0.0;
+}
+
+double SimulationReport::turnsPerRun() const
+{
+    return runs > 0 ? static_cast<double>(totalTurns) / runs : 0.0;
+}
+
+double SimulationReport::runsPerSecond() const
+{
+    return elapsedSeconds > 0.0 ? runs / elapsedSeconds : 0.0;
+}
+
+void SimulationReport::print(std::ostream &out) const
+{
+    out << "📊 SIMULATION REPORT 📊\n";
+    out << "=======================\n";
+    out << "Seed:           " << seed << "\n";
+    out << "Runs:           " << runs << "\n";
+    out << "Victories:      " << victories << "\n";
+    out << "Defeats:        " << defeats << "\n";
+    out << "Abandoned:      " << abandoned << "\n";
+    out << "Win rate:       " << winRate() * 100.0 << "%\n";
+    out << "Turns per run:  " << turnsPerRun() << "\n";
+    out << "Runs per second: " << runsPerSecond() << "\n";
+    out << "Elapsed:        " << elapsedSeconds << " s" << std::endl;
+}
+
+Simulator::Simulator(DecisionPolicy &policy, const SimulationConfig &config)
+    : policy(policy), config(config) {}
+
+SimulationReport Simulator::run()
+{
+    SimulationReport report;
+    report.seed = config.seed;
+    std::unique_ptr<OutputSink> sink;
+    if (config.logPath.empty())
+    {
+        sink = std::make_unique<NullSink>();
+    }
+    else
+    {
+        sink = std::make_unique<AsyncFileSink>(config.logPath);
+    }
+    std::unique_ptr<CombatEventFile> events;
+    if (!config.eventsPath.empty())
+    {
+        events = std::make_unique<CombatEventFile>(config.eventsPath);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (long long i = 0; i < config.runs; ++i)
+    {
+        Game game(&policy, RandomService::deriveSeed(config.seed, i), sink.get());
+        game.setEventFile(events.get());
+        while (game.step() && game.getTurnCount() < config.maxTurnsPerRun)
+        {
+        }
+
+        report.runs++;
+        report.totalTurns += game.getTurnCount();
+
+        if (game.getState() == GameState::VICTORY)
+        {
+            report.victories++;
+        }
+        else if (!game.getPlayer().isAlive())
+        {
+            report.defeats++;
+        }
+        else
+        {
+            report.abandoned++;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    report.elapsedSeconds = std::chrono::duration<double>(end - start).count();
+
+    return report;
+}
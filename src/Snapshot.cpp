@@ -0,0 +1,240 @@
+#include "Snapshot.h"
+#include <cstdio>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::is_trivially_copyable_v<SnapshotHeader>, "snapshot records must be plain data");
+static_assert(sizeof(SnapshotHeader) % 8 == 0 && sizeof(SnapshotEnemy) % 8 == 0,
+              "snapshot sections must stay 8-byte aligned");
+
+namespace
+{
+    std::size_t fixedSize(std::size_t enemyCount)
+    {
+        return sizeof(SnapshotHeader) + enemyCount * sizeof(SnapshotEnemy);
+    }
+}
+
+SnapshotView::SnapshotView(const void *data, std::size_t size)
+    : data(static_cast<const char *>(data)), size(size), valid(false)
+{
+    valid = validate();
+}
+
+bool SnapshotView::validString(const SnapshotString &text) const
+{
+    const SnapshotHeader &head = header();
+    return text.offset <= head.stringBytes && text.length <= head.stringBytes - text.offset;
+}
+
+bool SnapshotView::validate() const
+{
+    if (data == nullptr || size < sizeof(SnapshotHeader) ||
+        reinterpret_cast<std::uintptr_t>(data) % alignof(SnapshotHeader) != 0)
+    {
+        return false;
+    }
+
+    const SnapshotHeader &head = header();
+    if (head.magic != SNAPSHOT_MAGIC || head.version != SNAPSHOT_VERSION ||
+        head.headerSize != sizeof(SnapshotHeader) || head.totalSize > size)
+    {
+        return false;
+    }
+
+    // Counts are 32-bit, so this sum cannot overflow 64 bits
+    std::uint64_t expected = sizeof(SnapshotHeader) +
+                             std::uint64_t(head.enemyCount) * sizeof(SnapshotEnemy) +
+                             head.stringBytes;
+    if (expected != head.totalSize)
+    {
+        return false;
+    }
+
+    if (!validString(head.player.entity.name))
+    {
+        return false;
+    }
+    for (std::uint32_t i = 0; i < head.enemyCount; ++i)
+    {
+        if (!validString(enemies()[i].archetype))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SnapshotView::isValid() const
+{
+    return valid;
+}
+
+const SnapshotHeader &SnapshotView::header() const
+{
+    return *reinterpret_cast<const SnapshotHeader *>(data);
+}
+
+const SnapshotEnemy *SnapshotView::enemies() const
+{
+    return reinterpret_cast<const SnapshotEnemy *>(data + sizeof(SnapshotHeader));
+}
+
+std::string_view SnapshotView::string(const SnapshotString &text) const
+{
+    const SnapshotHeader &head = header();
+    const char *strings = data + fixedSize(head.enemyCount);
+    return std::string_view(strings + text.offset, text.length);
+}
+
+SnapshotWriter::SnapshotWriter(std::vector<char> &buffer, std::size_t enemyCount)
+    : buffer(buffer), stringsStart(fixedSize(enemyCount))
+{
+    buffer.assign(stringsStart, 0);
+
+    SnapshotHeader &head = header();
+    head.magic = SNAPSHOT_MAGIC;
+    head.version = SNAPSHOT_VERSION;
+    head.headerSize = sizeof(SnapshotHeader);
+    head.enemyCount = static_cast<std::uint32_t>(enemyCount);
+}
+
+SnapshotHeader &SnapshotWriter::header()
+{
+    return *reinterpret_cast<SnapshotHeader *>(buffer.data());
+}
+
+SnapshotEnemy &SnapshotWriter::enemy(std::size_t index)
+{
+    return reinterpret_cast<SnapshotEnemy *>(buffer.data() + sizeof(SnapshotHeader))[index];
+}
+
+SnapshotString SnapshotWriter::addString(std::string_view text)
+{
+    SnapshotString added{static_cast<std::uint32_t>(buffer.size() - stringsStart),
+                         static_cast<std::uint32_t>(text.size())};
+    buffer.insert(buffer.end(), text.begin(), text.end());
+    return added;
+}
+
+void SnapshotWriter::finish()
+{
+    // Pad so snapshots can be concatenated or mapped back to back
+    buffer.resize((buffer.size() + 7) & ~std::size_t(7), 0);
+
+    SnapshotHeader &head = header();
+    head.totalSize = static_cast<std::uint32_t>(buffer.size());
+    head.stringBytes = static_cast<std::uint32_t>(buffer.size() - stringsStart);
+}
+
+MappedFile::MappedFile(const std::string &path)
+    : data(nullptr), size(0)
+{
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    mappingHandle = nullptr;
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        fileHandle = nullptr;
+        return;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        return;
+    }
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        return;
+    }
+    data = static_cast<const char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    size = data ? static_cast<std::size_t>(fileSize.QuadPart) : 0;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void *mapped = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            data = static_cast<const char *>(mapped);
+            size = static_cast<std::size_t>(info.st_size);
+        }
+    }
+    close(fd); // The mapping keeps the file alive
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (data)
+    {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle)
+    {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle)
+    {
+        CloseHandle(fileHandle);
+    }
+#else
+    if (data)
+    {
+        munmap(const_cast<char *>(data), size);
+    }
+#endif
+}
+
+bool MappedFile::isOpen() const
+{
+    return data != nullptr;
+}
+
+const char *MappedFile::getData() const
+{
+    return data;
+}
+
+std::size_t MappedFile::getSize() const
+{
+    return size;
+}
+
+bool writeSnapshotFile(const std::string &path, const std::vector<char> &buffer)
+{
+    std::string temporary = path + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    written = std::fclose(file) == 0 && written;
+    if (!written)
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    return MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+}
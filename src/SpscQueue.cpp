@@ -0,0 +1,68 @@
+#include "SpscQueue.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    std::size_t roundUpToPowerOfTwo(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+SpscByteQueue::SpscByteQueue(std::size_t capacity)
+    : buffer(roundUpToPowerOfTwo(std::max<std::size_t>(capacity, 2))),
+      mask(buffer.size() - 1),
+      head(0),
+      tail(0) {}
+
+std::size_t SpscByteQueue::tryPush(const char *data, std::size_t size)
+{
+    std::size_t currentTail = tail.load(std::memory_order_relaxed);
+    std::size_t currentHead = head.load(std::memory_order_acquire);
+    std::size_t freeSpace = buffer.size() - (currentTail - currentHead);
+    std::size_t count = std::min(size, freeSpace);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    std::size_t offset = currentTail & mask;
+    std::size_t firstPart = std::min(count, buffer.size() - offset);
+    std::memcpy(buffer.data() + offset, data, firstPart);
+    std::memcpy(buffer.data(), data + firstPart, count - firstPart);
+
+    tail.store(currentTail + count, std::memory_order_seq_cst);
+    return count;
+}
+
+SpscByteQueue::Spans SpscByteQueue::readable() const
+{
+    std::size_t currentHead = head.load(std::memory_order_relaxed);
+    std::size_t currentTail = tail.load(std::memory_order_seq_cst);
+    std::size_t count = currentTail - currentHead;
+
+    std::size_t offset = currentHead & mask;
+    std::size_t firstPart = std::min(count, buffer.size() - offset);
+    return Spans{buffer.data() + offset, firstPart, buffer.data(), count - firstPart};
+}
+
+void SpscByteQueue::consume(std::size_t size)
+{
+    head.store(head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+}
+
+bool SpscByteQueue::empty() const
+{
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_seq_cst);
+}
+
+std::size_t SpscByteQueue::capacity() const
+{
+    return buffer.size();
+}
@@ -0,0 +1,72 @@
+#include "Task.h"
+#include <new>
+
+namespace
+{
+    const std::size_t FRAME_GRANULE = 64;
+    const std::size_t FRAME_CLASSES = 32; // Frames up to 2 KB are recycled
+
+    struct FreeFrame
+    {
+        FreeFrame *next;
+    };
+
+    // Free lists by size class. A frame freed on another thread (a session
+    // that moved workers) simply joins that thread's list.
+    struct FrameCache
+    {
+        FreeFrame *lists[FRAME_CLASSES] = {};
+
+        ~FrameCache()
+        {
+            for (FreeFrame *&list : lists)
+            {
+                while (list)
+                {
+                    FreeFrame *frame = list;
+                    list = frame->next;
+                    ::operator delete(frame);
+                }
+            }
+        }
+    };
+
+    thread_local FrameCache frameCache;
+
+    std::size_t sizeClass(std::size_t size)
+    {
+        return (size + FRAME_GRANULE - 1) / FRAME_GRANULE - 1;
+    }
+}
+
+void *detail::allocateFrame(std::size_t size)
+{
+    std::size_t index = sizeClass(size);
+    if (index >= FRAME_CLASSES)
+    {
+        return ::operator new(size);
+    }
+
+    FreeFrame *&list = frameCache.lists[index];
+    if (list)
+    {
+        FreeFrame *frame = list;
+        list = frame->next;
+        return frame;
+    }
+    return ::operator new((index + 1) * FRAME_GRANULE);
+}
+
+void detail::freeFrame(void *frame, std::size_t size) noexcept
+{
+    std::size_t index = sizeClass(size);
+    if (index >= FRAME_CLASSES)
+    {
+        ::operator delete(frame);
+        return;
+    }
+
+    FreeFrame *freed = static_cast<FreeFrame *>(frame);
+    freed->next = frameCache.lists[index];
+    frameCache.lists[index] = freed;
+}
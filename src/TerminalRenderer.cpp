@@ -0,0 +1,291 @@
+#include "TerminalRenderer.h"
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    struct CodepointRange
+    {
+        std::uint32_t first;
+        std::uint32_t last;
+    };
+
+    // Characters terminals draw two columns wide: East Asian wide/fullwidth
+    // blocks plus every emoji with default emoji presentation (sorted)
+    const CodepointRange WIDE_RANGES[] = {
+        {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC}, {0x23F0, 0x23F0},
+        {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615}, {0x2648, 0x2653}, {0x267F, 0x267F},
+        {0x2693, 0x2693}, {0x26A1, 0x26A1}, {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5},
+        {0x26CE, 0x26CE}, {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+        {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B}, {0x2728, 0x2728},
+        {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755}, {0x2757, 0x2757}, {0x2795, 0x2797},
+        {0x27B0, 0x27B0}, {0x27BF, 0x27BF}, {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55},
+        {0x2E80, 0x303E}, {0x3041, 0x33FF}, {0x3400, 0x4DBF}, {0x4E00, 0x9FFF}, {0xA000, 0xA4CF},
+        {0xA960, 0xA97F}, {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE6F},
+        {0xFF00, 0xFF60}, {0xFFE0, 0xFFE6}, {0x1F004, 0x1F004}, {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E},
+        {0x1F191, 0x1F19A}, {0x1F200, 0x1F202}, {0x1F210, 0x1F23B}, {0x1F240, 0x1F248}, {0x1F250, 0x1F251},
+        {0x1F260, 0x1F265}, {0x1F300, 0x1F320}, {0x1F32D, 0x1F335}, {0x1F337, 0x1F37C}, {0x1F37E, 0x1F393},
+        {0x1F3A0, 0x1F3CA}, {0x1F3CF, 0x1F3D3}, {0x1F3E0, 0x1F3F0}, {0x1F3F4, 0x1F3F4}, {0x1F3F8, 0x1F43E},
+        {0x1F440, 0x1F440}, {0x1F442, 0x1F4FC}, {0x1F4FF, 0x1F53D}, {0x1F54B, 0x1F54E}, {0x1F550, 0x1F567},
+        {0x1F57A, 0x1F57A}, {0x1F595, 0x1F596}, {0x1F5A4, 0x1F5A4}, {0x1F5FB, 0x1F64F}, {0x1F680, 0x1F6C5},
+        {0x1F6CC, 0x1F6CC}, {0x1F6D0, 0x1F6D2}, {0x1F6D5, 0x1F6D7}, {0x1F6DC, 0x1F6DF}, {0x1F6EB, 0x1F6EC},
+        {0x1F6F4, 0x1F6FC}, {0x1F7E0, 0x1F7EB}, {0x1F7F0, 0x1F7F0}, {0x1F90C, 0x1F93A}, {0x1F93C, 0x1F945},
+        {0x1F947, 0x1F9FF}, {0x1FA70, 0x1FAFF}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD},
+    };
+
+    bool isWide(std::uint32_t codepoint)
+    {
+        const CodepointRange *end = WIDE_RANGES + sizeof(WIDE_RANGES) / sizeof(WIDE_RANGES[0]);
+        const CodepointRange *it = std::upper_bound(WIDE_RANGES, end, codepoint,
+                                                    [](std::uint32_t value, const CodepointRange &range)
+                                                    { return value < range.first; });
+        return it != WIDE_RANGES && codepoint <= (it - 1)->last;
+    }
+
+    bool isZeroWidth(std::uint32_t codepoint)
+    {
+        return (codepoint >= 0x0300 && codepoint <= 0x036F) || // Combining diacritics
+               (codepoint >= 0x200B && codepoint <= 0x200F) || // Zero-width space/joiners, marks
+               (codepoint >= 0xFE00 && codepoint <= 0xFE0F) || // Variation selectors
+               (codepoint >= 0x1F3FB && codepoint <= 0x1F3FF) || // Skin tone modifiers
+               (codepoint >= 0xE0020 && codepoint <= 0xE007F);  // Tag characters
+    }
+
+    // Decode one UTF-8 sequence starting at text[i]; invalid bytes decode as themselves
+    std::uint32_t decode(std::string_view text, std::size_t &i)
+    {
+        unsigned char lead = static_cast<unsigned char>(text[i++]);
+        int extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+        std::uint32_t codepoint = extra == 3 ? lead & 0x07 : extra == 2 ? lead & 0x0F : extra == 1 ? lead & 0x1F : lead;
+        for (int k = 0; k < extra && i < text.size(); ++k)
+        {
+            codepoint = (codepoint << 6) | (static_cast<unsigned char>(text[i++]) & 0x3F);
+        }
+        return codepoint;
+    }
+
+    void appendNumber(std::string &out, int value)
+    {
+        char digits[12];
+        int length = 0;
+        do
+        {
+            digits[length++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (length > 0)
+        {
+            out.push_back(digits[--length]);
+        }
+    }
+
+    // ESC[row;columnH (1-based)
+    void moveCursor(std::string &out, int row, int column)
+    {
+        out += "\033[";
+        appendNumber(out, row);
+        out.push_back(';');
+        appendNumber(out, column);
+        out.push_back('H');
+    }
+}
+
+int displayWidth(std::string_view utf8)
+{
+    int width = 0;
+    int lastWidth = 0;   // Width of the previous visible character
+    bool joined = false; // Previous codepoint was a zero-width joiner
+
+    std::size_t i = 0;
+    while (i < utf8.size())
+    {
+        std::uint32_t codepoint = decode(utf8, i);
+
+        if (codepoint == 0x200D)
+        {
+            joined = true;
+            continue;
+        }
+        if (codepoint == 0xFE0F)
+        {
+            // Emoji presentation selector turns a narrow symbol (e.g. ❤ ⚔ 🛡) into a wide emoji
+            if (lastWidth == 1)
+            {
+                width += 1;
+                lastWidth = 2;
+            }
+            continue;
+        }
+        if (joined || isZeroWidth(codepoint) || codepoint < 0x20)
+        {
+            // Part of a ZWJ sequence (👨‍🦰, 🏃‍♂️) or a modifier: drawn inside the previous glyph
+            joined = false;
+            continue;
+        }
+
+        lastWidth = isWide(codepoint) ? 2 : 1;
+        width += lastWidth;
+    }
+    return width;
+}
+
+TerminalRenderer::TerminalRenderer()
+    : fullRedraw(true), columns(80), rows(24)
+{
+    pending.emplace_back();
+    querySize();
+}
+
+void TerminalRenderer::append(std::vector<std::string> &lines, std::string_view text)
+{
+    std::size_t start = 0;
+    while (start <= text.size())
+    {
+        std::size_t newline = text.find('\n', start);
+        if (newline == std::string_view::npos)
+        {
+            lines.back().append(text.substr(start));
+            return;
+        }
+        lines.back().append(text.substr(start, newline - start));
+        lines.emplace_back();
+        start = newline + 1;
+    }
+}
+
+int TerminalRenderer::rowsFor(const std::string &line) const
+{
+    int width = displayWidth(line);
+    return width == 0 ? 1 : (width + columns - 1) / columns;
+}
+
+void TerminalRenderer::querySize()
+{
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+    {
+        columns = info.srWindow.Right - info.srWindow.Left + 1;
+        rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+    }
+#else
+    winsize size{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0)
+    {
+        columns = size.ws_col;
+        rows = size.ws_row;
+    }
+#endif
+}
+
+void TerminalRenderer::present()
+{
+    update.clear();
+
+    // Terminal row each pending line starts on
+    std::vector<int> rowStarts;
+    rowStarts.reserve(pending.size());
+    int totalRows = 0;
+    for (const std::string &line : pending)
+    {
+        rowStarts.push_back(totalRows + 1);
+        totalRows += rowsFor(line);
+    }
+
+    if (fullRedraw || totalRows > rows)
+    {
+        // Repaint everything; if the screen overflows the terminal it scrolls,
+        // so row addressing is only trusted again after the next clear
+        update += "\033[H\033[2J\033[3J";
+        for (std::size_t i = 0; i < pending.size(); ++i)
+        {
+            if (i > 0)
+            {
+                update.push_back('\n');
+            }
+            update += pending[i];
+        }
+        fullRedraw = totalRows > rows;
+    }
+    else
+    {
+        update += "\033[?25l"; // Hide the cursor while lines are rewritten
+
+        for (std::size_t i = 0; i < pending.size(); ++i)
+        {
+            bool unchanged = i < screen.size() && screenRowStarts[i] == rowStarts[i] && screen[i] == pending[i];
+            if (unchanged)
+            {
+                continue;
+            }
+            moveCursor(update, rowStarts[i], 1);
+            update += pending[i];
+            update += "\033[K"; // Clear the rest of the old line
+        }
+
+        // Erase rows the previous screen used below the new last line
+        int oldRows = screen.empty() ? 0 : screenRowStarts.back() + rowsFor(screen.back()) - 1;
+        if (oldRows > totalRows)
+        {
+            moveCursor(update, totalRows + 1, 1);
+            update += "\033[J";
+        }
+
+        // Leave the cursor where the last line ends (the prompt)
+        int lastWidth = displayWidth(pending.back());
+        int lastRow = rowStarts.back() + (lastWidth > 0 ? (lastWidth - 1) / columns : 0);
+        int lastColumn = lastWidth == 0 ? 1 : (lastWidth - 1) % columns + 2;
+        moveCursor(update, lastRow, std::min(lastColumn, columns));
+        update += "\033[?25h";
+    }
+
+    if (update.size() > 0)
+    {
+        terminal.writeFrame(update);
+    }
+    screen = pending;
+    screenRowStarts = std::move(rowStarts);
+}
+
+void TerminalRenderer::writeFrame(std::string_view frame)
+{
+    append(pending, frame);
+    present();
+}
+
+void TerminalRenderer::clearScreen()
+{
+    // Nothing is sent yet: the next frame is diffed against what is on screen
+    pending.clear();
+    pending.emplace_back();
+    querySize();
+}
+
+void TerminalRenderer::noteInput(std::string_view line)
+{
+    // The terminal echoed the line and moved to the next row; mirror that in both models
+    append(pending, line);
+    pending.emplace_back();
+    if (!screen.empty())
+    {
+        screen.back().append(line);
+        screen.emplace_back();
+        screenRowStarts.push_back(screenRowStarts.back() + rowsFor(screen[screen.size() - 2]));
+        if (screenRowStarts.back() > rows)
+        {
+            fullRedraw = true; // The echo scrolled the terminal
+        }
+    }
+}
+
+void TerminalRenderer::drain()
+{
+    terminal.drain();
+}
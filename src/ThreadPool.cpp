@@ -0,0 +1,139 @@
+#include "ThreadPool.h"
+#include <chrono>
+
+namespace
+{
+    // Which pool and deque the calling thread works for (none outside a pool)
+    thread_local const ThreadPool *currentPool = nullptr;
+    thread_local std::size_t currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+    : queued(0), unfinished(0), nextWorker(0), stopping(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0)
+    {
+        threadCount = 1;
+    }
+
+    for (std::size_t i = 0; i < threadCount; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    workAvailable.notify_all();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::size() const
+{
+    return workers.size();
+}
+
+void ThreadPool::submit(Task task)
+{
+    std::size_t target = currentPool == this
+                             ? currentWorker
+                             : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+    unfinished.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(workers[target]->mutex);
+        workers[target]->tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+
+    // Taking the lock orders this notify after a sleeping worker's last look at queued
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    workAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    allDone.wait(lock, [this]
+                 { return unfinished.load() == 0; });
+}
+
+bool ThreadPool::popLocal(std::size_t index, Task &task)
+{
+    Worker &worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(std::size_t thief, Task &task)
+{
+    for (std::size_t offset = 1; offset < workers.size(); ++offset)
+    {
+        Worker &victim = *workers[(thief + offset) % workers.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty())
+        {
+            continue;
+        }
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(std::size_t index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    Task task;
+    while (true)
+    {
+        if (popLocal(index, task) || steal(index, task))
+        {
+            queued.fetch_sub(1);
+            task();
+            task = nullptr;
+
+            if (unfinished.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping.load())
+        {
+            return;
+        }
+        // A steal can miss a task behind a busy lock, so recheck the count while asleep
+        workAvailable.wait_for(lock, std::chrono::milliseconds(10), [this]
+                               { return queued.load() > 0 || stopping.load(); });
+    }
+}
@@ -1,11 +1,365 @@
+#include "Balance.h"
+#include "CombatAdvisor.h"
+#include "CombatEvents.h"
+#include "Dialogue.h"
+#include "EnemyArchetype.h"
 #include "Game.h"
+#include "Metrics.h"
+#include "Replay.h"
+#include "SessionHost.h"
+#include "Simulator.h"
+#include <chrono>
+#include <csignal>
 #include <iostream>
+#include <string>
 
-int main()
+namespace
 {
-    // Create and run the game
-    Game game;
+    // The console game Ctrl+C should end (requestExit only stores an atomic flag)
+    Game *interruptTarget = nullptr;
+
+    void signalHandler(int)
+    {
+        if (interruptTarget)
+        {
+            interruptTarget->requestExit();
+        }
+    }
+
+    // "greedy" or "mcts"; null for anything else
+    std::unique_ptr<DecisionPolicy> makePolicy(const std::string &name, const AdvisorConfig &advisor)
+    {
+        if (name == "greedy")
+        {
+            return std::make_unique<GreedyPolicy>();
+        }
+        if (name == "mcts")
+        {
+            return std::make_unique<MctsPolicy>(advisor);
+        }
+        return nullptr;
+    }
+
+    // Plays config.runs bot games as concurrent sessions and reports like the simulator
+    SimulationReport runHost(const SimulationConfig &config, std::size_t threads,
+                             const std::string &policyName, AdvisorConfig advisor)
+    {
+        SessionHostConfig hostConfig;
+        hostConfig.threads = threads;
+        hostConfig.maxTurnsPerSession = config.maxTurnsPerRun;
+        std::unique_ptr<CombatEventFile> events; // Declared first so it outlives the sessions
+        if (!config.eventsPath.empty())
+        {
+            events = std::make_unique<CombatEventFile>(config.eventsPath);
+            hostConfig.events = events.get();
+        }
+
+        SimulationReport report;
+        report.seed = config.seed;
+        auto start = std::chrono::steady_clock::now();
+
+        SessionHost host(hostConfig);
+        advisor.threads = 1; // The host already runs one session per core
+        for (long long i = 0; i < config.runs; ++i)
+        {
+            std::uint64_t seed = RandomService::deriveSeed(config.seed, i);
+            advisor.seed = seed;
+            host.addBotSession(makePolicy(policyName, advisor), seed);
+        }
+        host.wait();
+
+        for (SessionHost::SessionId id = 0; id < host.sessionCount(); ++id)
+        {
+            SessionResult result = host.result(id);
+            report.runs++;
+            report.totalTurns += result.turns;
+            if (result.state == GameState::VICTORY)
+            {
+                report.victories++;
+            }
+            else if (!result.playerAlive)
+            {
+                report.defeats++;
+            }
+            else
+            {
+                report.abandoned++;
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        report.elapsedSeconds = std::chrono::duration<double>(end - start).count();
+        return report;
+    }
+
+    const char *stateName(GameState state)
+    {
+        switch (state)
+        {
+        case GameState::MAIN_MENU:
+            return "main menu";
+        case GameState::EXPLORING:
+            return "exploring";
+        case GameState::COMBAT:
+            return "combat";
+        case GameState::SHOP:
+            return "shop";
+        case GameState::TALKING_TO_NPC:
+            return "talking to NPC";
+        case GameState::GAME_OVER:
+            return "game over";
+        case GameState::VICTORY:
+            return "victory";
+        }
+        return "unknown";
+    }
+
+    // Rebuilds a recorded session up to a turn (or its end) and reports where it stands
+    int runReplay(const std::string &path, int toTurn)
+    {
+        SessionReplay replay;
+        std::string error;
+        if (!replay.load(path, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        ReplayedSession session = replay.seek(toTurn);
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (session.damagedCheckpoints > 0)
+        {
+            std::cerr << path << ": skipped " << session.damagedCheckpoints
+                      << " damaged checkpoint(s) and replayed from an earlier one" << std::endl;
+        }
+
+        const Game &game = *session.game;
+        const Player &player = game.getPlayer();
+        std::cout << "🎬 REPLAY 🎬\n";
+        std::cout << "Seed:           " << replay.getSeed() << "\n";
+        std::cout << "Input lines:    " << replay.lineCount() << "\n";
+        std::cout << "Checkpoints:    " << replay.checkpointCount() << "\n";
+        std::cout << "Reached turn:   " << game.getTurnCount() << " in " << milliseconds << " ms\n";
+        std::cout << "State:          " << stateName(game.getState()) << "\n";
+        std::cout << "Dungeon level:  " << game.getCurrentDungeonLevel() << "\n";
+        std::cout << "Player:         " << player.getName() << ", level " << player.getLevel() << ", "
+                  << player.getHealth() << "/" << player.getMaxHealth() << " health, "
+                  << player.getBDP() << " BDP" << std::endl;
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // Headless balance runs: dungeon_crawler --simulate <runs> [--max-turns <n>] [--seed <n>] [--log <file>]
+    // The same games as concurrent sessions: dungeon_crawler --host <sessions> [--threads <n>] [--max-turns <n>] [--seed <n>]
+    // Bots play with --policy greedy (default) or --policy mcts, the combat advisor, which thinks for
+    // --advisor-ms <ms> per move (default 5) or, for repeatable runs, exactly --advisor-rollouts <n>;
+    // in --simulate, --threads sets its search threads
+    // Any mode can swap in other enemy types: --enemies <file> (format in EnemyArchetype.h)
+    // or other balance parameters: --balance <file> (format in Balance.h, written by balance_sweep)
+    // or a compiled dialogue corpus: --dialogue <file> (built from content/dialogue.txt by dialogue_compiler)
+    // and export metrics: --metrics <file> [--metrics-interval <seconds>] (Prometheus text format)
+    // or combat events: --events <file> (binary, read with event_decoder)
+    // Record the console game for bug reports: dungeon_crawler --record <file> [--checkpoint-every <turns>] [--seed <n>]
+    // and rebuild it later: dungeon_crawler --replay <file> [--to-turn <n>]
+    SimulationConfig config;
+    bool simulate = false;
+    bool host = false;
+    bool seedGiven = false;
+    std::size_t threads = 0;
+    std::string recordPath;
+    int checkpointEvery = 100;
+    std::string replayPath;
+    int toTurn = -1;
+    std::string metricsPath;
+    double metricsInterval = 5.0;
+    std::string policyName = "greedy";
+    AdvisorConfig advisor;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--simulate" && i + 1 < argc)
+        {
+            simulate = true;
+            config.runs = std::stoll(argv[++i]);
+        }
+        else if (arg == "--host" && i + 1 < argc)
+        {
+            host = true;
+            config.runs = std::stoll(argv[++i]);
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            threads = std::stoul(argv[++i]);
+        }
+        else if (arg == "--policy" && i + 1 < argc)
+        {
+            policyName = argv[++i];
+        }
+        else if (arg == "--advisor-ms" && i + 1 < argc)
+        {
+            advisor.budget = std::chrono::microseconds(static_cast<long long>(std::stod(argv[++i]) * 1000));
+        }
+        else if (arg == "--advisor-rollouts" && i + 1 < argc)
+        {
+            advisor.maxRollouts = std::stoull(argv[++i]);
+            advisor.budget = std::chrono::microseconds(0);
+        }
+        else if (arg == "--max-turns" && i + 1 < argc)
+        {
+            config.maxTurnsPerRun = std::stoi(argv[++i]);
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            config.seed = std::stoull(argv[++i]);
+            seedGiven = true;
+        }
+        else if (arg == "--record" && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (arg == "--checkpoint-every" && i + 1 < argc)
+        {
+            checkpointEvery = std::stoi(argv[++i]);
+        }
+        else if (arg == "--replay" && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (arg == "--to-turn" && i + 1 < argc)
+        {
+            toTurn = std::stoi(argv[++i]);
+        }
+        else if (arg == "--log" && i + 1 < argc)
+        {
+            config.logPath = argv[++i];
+        }
+        else if (arg == "--events" && i + 1 < argc)
+        {
+            config.eventsPath = argv[++i];
+        }
+        else if (arg == "--metrics" && i + 1 < argc)
+        {
+            metricsPath = argv[++i];
+        }
+        else if (arg == "--metrics-interval" && i + 1 < argc)
+        {
+            metricsInterval = std::stod(argv[++i]);
+        }
+        else if (arg == "--enemies" && i + 1 < argc)
+        {
+            std::string error;
+            if (!EnemyRegistry::loadFile(argv[++i], error))
+            {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--dialogue" && i + 1 < argc)
+        {
+            std::string error;
+            if (!DialogueCorpus::loadFile(argv[++i], error))
+            {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--balance" && i + 1 < argc)
+        {
+            std::string error;
+            BalanceParams params;
+            if (!Balance::loadFile(argv[++i], params, error))
+            {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+            Balance::set(params);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--simulate <runs> | --host <sessions> [--threads <n>]] [--max-turns <n>] [--seed <n>] [--log <file>]"
+                      << " [--policy greedy|mcts [--advisor-ms <ms> | --advisor-rollouts <n>]]"
+                      << " [--enemies <file>] [--balance <file>] [--dialogue <file>] [--metrics <file> [--metrics-interval <seconds>]] [--events <file>]"
+                      << " [--record <file> [--checkpoint-every <turns>] | --replay <file> [--to-turn <n>]]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    // Written every interval and once more on the way out
+    std::unique_ptr<MetricsExporter> metrics;
+    if (!metricsPath.empty())
+    {
+        if (!metricsCompiledIn())
+        {
+            std::cerr << "This build has metrics compiled out (DUNGEON_METRICS=OFF)" << std::endl;
+            return 1;
+        }
+        auto interval = std::chrono::milliseconds(static_cast<long long>(metricsInterval * 1000));
+        metrics = std::make_unique<MetricsExporter>(metricsPath, interval);
+    }
+
+    if (policyName != "greedy" && policyName != "mcts")
+    {
+        std::cerr << "Unknown policy " << policyName << " (expected greedy or mcts)" << std::endl;
+        return 1;
+    }
+
+    if (simulate)
+    {
+        advisor.threads = static_cast<unsigned>(threads);
+        advisor.seed = config.seed;
+        std::unique_ptr<DecisionPolicy> policy = makePolicy(policyName, advisor);
+        Simulator simulator(*policy, config);
+        simulator.run().print(std::cout);
+        return 0;
+    }
+
+    if (host)
+    {
+        runHost(config, threads, policyName, advisor).print(std::cout);
+        return 0;
+    }
+
+    if (!replayPath.empty())
+    {
+        return runReplay(replayPath, toTurn);
+    }
+
+    // Create and run the game; the event file is flushed when the game ends, so it is made first
+    std::unique_ptr<CombatEventFile> events;
+    if (!config.eventsPath.empty())
+    {
+        events = std::make_unique<CombatEventFile>(config.eventsPath);
+        if (!events->isOpen())
+        {
+            std::cerr << "Could not write " << config.eventsPath << std::endl;
+            return 1;
+        }
+    }
+    Game game(nullptr, seedGiven ? config.seed : RandomService::entropySeed());
+    game.setEventFile(events.get());
+    std::unique_ptr<SessionRecorder> recorder;
+    if (!recordPath.empty())
+    {
+        recorder = std::make_unique<SessionRecorder>(recordPath, game.getSeed(), checkpointEvery);
+        if (!recorder->isOpen())
+        {
+            std::cerr << "Could not write " << recordPath << std::endl;
+            return 1;
+        }
+        game.setRecorder(recorder.get());
+    }
+    interruptTarget = &game;
+    std::signal(SIGINT, signalHandler); // Ctrl+C
     game.run();
+    std::signal(SIGINT, SIG_DFL);
+    interruptTarget = nullptr;
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,446 @@
+#include "Balance.h"
+#include "CombatAdvisor.h"
+#include "Game.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Balance tuner: plays thousands of bot games per parameter set on every core
+// and looks for the set (Balance.h) whose clear rate on each dungeon level is
+// closest to a target curve. A level's clear rate is the share of runs that
+// reached it and got past it (beat the boss, on the last level).
+//
+// Grid sweeps try every combination of the listed ranges. Evolution starts
+// from the base set and each generation keeps the best of a population of
+// mutations, stopping early once the error is within tolerance. Every set is
+// played on the same seeds, so differences come from the parameters and not
+// from the dice.
+//
+// Usage: balance_sweep [--runs <n>] [--seed <n>] [--threads <n>] [--max-turns <n>]
+//                      [--policy greedy|mcts [--advisor-rollouts <n>]]
+//                      [--base <file>] [--targets <rate>,<rate>,...]
+//                      [--grid <name>=<low>:<high>:<step>]...
+//                      [--evolve <generations> [--population <n>] [--tune <name>,<name>,...] [--tolerance <error>]]
+//                      [--out <file>]
+
+namespace
+{
+    struct SweepConfig
+    {
+        long long runs = 2000;
+        std::uint64_t seed = 1;
+        int maxTurns = 10000;
+        std::string policy = "greedy";
+        std::uint64_t advisorRollouts = 200;
+        std::vector<double> targets{0.99, 0.97, 0.95, 0.9, 0.6};
+    };
+
+    struct Evaluation
+    {
+        BalanceParams params;
+        std::vector<double> clearRates; // Per dungeon level, from level 1
+        double winRate = 0.0;
+        double error = 0.0; // Sum of squared distances from the targets
+    };
+
+    struct GridAxis
+    {
+        const BalanceField *field;
+        int low;
+        int high;
+        int step;
+    };
+
+    const long long RUNS_PER_TASK = 64;
+
+    std::vector<std::string> split(const std::string &text, char separator)
+    {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, separator))
+        {
+            parts.push_back(part);
+        }
+        return parts;
+    }
+
+    std::unique_ptr<DecisionPolicy> makePolicy(const SweepConfig &config, std::uint64_t seed)
+    {
+        if (config.policy == "mcts")
+        {
+            AdvisorConfig advisor;
+            advisor.budget = std::chrono::microseconds(0);
+            advisor.maxRollouts = config.advisorRollouts;
+            advisor.threads = 1; // Runs are already spread over the cores
+            advisor.seed = seed;
+            return std::make_unique<MctsPolicy>(advisor);
+        }
+        return std::make_unique<GreedyPolicy>();
+    }
+
+    // Plays config.runs games with params in force, RUNS_PER_TASK to a pool task
+    Evaluation evaluate(const BalanceParams &params, const SweepConfig &config, ThreadPool &pool)
+    {
+        Balance::set(params);
+        std::size_t levels = config.targets.size();
+        long long tasks = (config.runs + RUNS_PER_TASK - 1) / RUNS_PER_TASK;
+
+        // Per task: reached[level], cleared[level], victories
+        std::vector<std::vector<long long>> tallies(tasks, std::vector<long long>(2 * levels + 1, 0));
+        for (long long task = 0; task < tasks; ++task)
+        {
+            pool.submit([&, task]
+                        {
+                std::vector<long long> &tally = tallies[task];
+                long long end = std::min(config.runs, (task + 1) * RUNS_PER_TASK);
+                for (long long run = task * RUNS_PER_TASK; run < end; ++run)
+                {
+                    std::uint64_t seed = RandomService::deriveSeed(config.seed, run);
+                    std::unique_ptr<DecisionPolicy> policy = makePolicy(config, seed);
+                    Game game(policy.get(), seed);
+                    while (game.step() && game.getTurnCount() < config.maxTurns)
+                    {
+                    }
+
+                    bool victory = game.getState() == GameState::VICTORY;
+                    std::size_t last = std::min<std::size_t>(game.getCurrentDungeonLevel(), levels);
+                    for (std::size_t level = 1; level <= last; ++level)
+                    {
+                        tally[level - 1]++;
+                        if (level < last || victory)
+                        {
+                            tally[levels + level - 1]++;
+                        }
+                    }
+                    tally[2 * levels] += victory ? 1 : 0;
+                } });
+        }
+        pool.wait();
+
+        Evaluation result;
+        result.params = params;
+        std::vector<long long> total(2 * levels + 1, 0);
+        for (const std::vector<long long> &tally : tallies)
+        {
+            for (std::size_t i = 0; i < total.size(); ++i)
+            {
+                total[i] += tally[i];
+            }
+        }
+        for (std::size_t level = 0; level < levels; ++level)
+        {
+            // A level nobody reached counts as never cleared
+            double rate = total[level] ? double(total[levels + level]) / total[level] : 0.0;
+            result.clearRates.push_back(rate);
+            result.error += (rate - config.targets[level]) * (rate - config.targets[level]);
+        }
+        result.winRate = double(total[2 * levels]) / config.runs;
+        return result;
+    }
+
+    // Parameters that differ from the defaults, e.g. "escape_in_ten=5 potion_price=15"
+    std::string describe(const BalanceParams &params)
+    {
+        BalanceParams defaults;
+        std::string text;
+        for (std::size_t i = 0; i < Balance::fieldCount(); ++i)
+        {
+            const BalanceField &field = Balance::fields()[i];
+            if (params.*(field.member) != defaults.*(field.member))
+            {
+                if (!text.empty())
+                {
+                    text += ' ';
+                }
+                text.append(field.name).append("=").append(std::to_string(params.*(field.member)));
+            }
+        }
+        return text.empty() ? "(defaults)" : text;
+    }
+
+    void print(const Evaluation &evaluation)
+    {
+        std::cout << std::fixed << std::setprecision(4) << "  error " << evaluation.error << "  clear";
+        for (double rate : evaluation.clearRates)
+        {
+            std::cout << ' ' << std::setprecision(3) << rate;
+        }
+        std::cout << "  win " << std::setprecision(3) << evaluation.winRate << "  " << describe(evaluation.params) << '\n';
+    }
+
+    std::vector<Evaluation> runGrid(const BalanceParams &base, const std::vector<GridAxis> &axes,
+                                    const SweepConfig &config, ThreadPool &pool)
+    {
+        std::vector<Evaluation> results;
+        std::vector<int> position(axes.size());
+        for (std::size_t i = 0; i < axes.size(); ++i)
+        {
+            position[i] = axes[i].low;
+        }
+
+        for (;;)
+        {
+            BalanceParams params = base;
+            for (std::size_t i = 0; i < axes.size(); ++i)
+            {
+                params.*(axes[i].field->member) = position[i];
+            }
+            results.push_back(evaluate(params, config, pool));
+            print(results.back());
+
+            // Odometer over the axes
+            std::size_t axis = 0;
+            for (; axis < axes.size(); ++axis)
+            {
+                position[axis] += axes[axis].step;
+                if (position[axis] <= axes[axis].high)
+                {
+                    break;
+                }
+                position[axis] = axes[axis].low;
+            }
+            if (axis == axes.size())
+            {
+                break;
+            }
+        }
+
+        std::sort(results.begin(), results.end(), [](const Evaluation &a, const Evaluation &b)
+                  { return a.error < b.error; });
+        return results;
+    }
+
+    // Nudges one to three of the tuned fields by up to a tenth of their range
+    BalanceParams mutate(const BalanceParams &params, const std::vector<const BalanceField *> &tuned, RandomStream &rng)
+    {
+        BalanceParams child = params;
+        int changes = rng.uniformInt(1, std::min<int>(3, static_cast<int>(tuned.size())));
+        for (int i = 0; i < changes; ++i)
+        {
+            const BalanceField &field = *tuned[rng.uniformInt(0, static_cast<int>(tuned.size()) - 1)];
+            int reach = std::max(1, (field.high - field.low) / 10);
+            int delta = rng.uniformInt(-reach, reach);
+            child.*(field.member) = std::clamp(child.*(field.member) + (delta ? delta : 1), field.low, field.high);
+        }
+        return child;
+    }
+
+    Evaluation runEvolution(const BalanceParams &base, int generations, int population,
+                            const std::vector<const BalanceField *> &tuned, double tolerance,
+                            const SweepConfig &config, ThreadPool &pool)
+    {
+        RandomStream rng(RandomService::deriveSeed(config.seed, ~0ull));
+        Evaluation best = evaluate(base, config, pool);
+        std::cout << "generation 0\n";
+        print(best);
+
+        for (int generation = 1; generation <= generations && best.error > tolerance; ++generation)
+        {
+            Evaluation leader = best;
+            for (int i = 0; i < population; ++i)
+            {
+                Evaluation candidate = evaluate(mutate(best.params, tuned, rng), config, pool);
+                if (candidate.error < leader.error)
+                {
+                    leader = candidate;
+                }
+            }
+            best = leader;
+            std::cout << "generation " << generation << '\n';
+            print(best);
+        }
+        return best;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    SweepConfig config;
+    std::size_t threads = 0;
+    BalanceParams base;
+    std::vector<GridAxis> axes;
+    int generations = 0;
+    int population = 16;
+    double tolerance = 0.0005;
+    std::vector<const BalanceField *> tuned;
+    std::string outPath;
+
+    auto usage = [&]
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--runs <n>] [--seed <n>] [--threads <n>] [--max-turns <n>]"
+                  << " [--policy greedy|mcts [--advisor-rollouts <n>]] [--base <file>] [--targets <rate>,...]"
+                  << " [--grid <name>=<low>:<high>:<step>]... [--evolve <generations> [--population <n>]"
+                  << " [--tune <name>,...] [--tolerance <error>]] [--out <file>]" << std::endl;
+        return 1;
+    };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--runs" && hasValue)
+        {
+            config.runs = std::max(1ll, std::stoll(argv[++i]));
+        }
+        else if (arg == "--seed" && hasValue)
+        {
+            config.seed = std::stoull(argv[++i]);
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            threads = std::stoul(argv[++i]);
+        }
+        else if (arg == "--max-turns" && hasValue)
+        {
+            config.maxTurns = std::stoi(argv[++i]);
+        }
+        else if (arg == "--policy" && hasValue)
+        {
+            config.policy = argv[++i];
+            if (config.policy != "greedy" && config.policy != "mcts")
+            {
+                return usage();
+            }
+        }
+        else if (arg == "--advisor-rollouts" && hasValue)
+        {
+            config.advisorRollouts = std::stoull(argv[++i]);
+        }
+        else if (arg == "--base" && hasValue)
+        {
+            std::string error;
+            if (!Balance::loadFile(argv[++i], base, error))
+            {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--targets" && hasValue)
+        {
+            config.targets.clear();
+            for (const std::string &rate : split(argv[++i], ','))
+            {
+                config.targets.push_back(std::stod(rate));
+            }
+        }
+        else if (arg == "--grid" && hasValue)
+        {
+            // name=low:high:step
+            std::string spec = argv[++i];
+            std::size_t equals = spec.find('=');
+            std::vector<std::string> range = split(spec.substr(equals == std::string::npos ? spec.size() : equals + 1), ':');
+            const BalanceField *field = Balance::findField(spec.substr(0, equals));
+            if (!field || range.size() != 3)
+            {
+                std::cerr << "Bad --grid " << spec << " (expected <name>=<low>:<high>:<step>)" << std::endl;
+                return 1;
+            }
+            int low = std::max(field->low, std::stoi(range[0]));
+            int high = std::min(field->high, std::stoi(range[1]));
+            axes.push_back({field, low, std::max(low, high), std::max(1, std::stoi(range[2]))});
+        }
+        else if (arg == "--evolve" && hasValue)
+        {
+            generations = std::stoi(argv[++i]);
+        }
+        else if (arg == "--population" && hasValue)
+        {
+            population = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--tune" && hasValue)
+        {
+            for (const std::string &name : split(argv[++i], ','))
+            {
+                const BalanceField *field = Balance::findField(name);
+                if (!field)
+                {
+                    std::cerr << "Unknown parameter " << name << std::endl;
+                    return 1;
+                }
+                tuned.push_back(field);
+            }
+        }
+        else if (arg == "--tolerance" && hasValue)
+        {
+            tolerance = std::stod(argv[++i]);
+        }
+        else if (arg == "--out" && hasValue)
+        {
+            outPath = argv[++i];
+        }
+        else
+        {
+            return usage();
+        }
+    }
+
+    if (tuned.empty())
+    {
+        for (std::size_t i = 0; i < Balance::fieldCount(); ++i)
+        {
+            tuned.push_back(&Balance::fields()[i]);
+        }
+    }
+
+    // The game has as many levels as a fresh run says; one target per level
+    GreedyPolicy probe;
+    std::size_t levels = static_cast<std::size_t>(Game(&probe, 1).getMaxDungeonLevel());
+    config.targets.resize(levels, config.targets.empty() ? 0.9 : config.targets.back());
+
+    ThreadPool pool(threads);
+    std::cout << "⚖️ BALANCE SWEEP ⚖️\n";
+    std::cout << config.runs << " runs per parameter set on " << pool.size() << " threads, policy " << config.policy
+              << ", targets";
+    for (double target : config.targets)
+    {
+        std::cout << ' ' << target;
+    }
+    std::cout << '\n';
+
+    auto start = std::chrono::steady_clock::now();
+    Evaluation best;
+    if (generations > 0)
+    {
+        best = runEvolution(base, generations, population, tuned, tolerance, config, pool);
+    }
+    else if (!axes.empty())
+    {
+        std::vector<Evaluation> results = runGrid(base, axes, config, pool);
+        std::cout << "\nbest " << std::min<std::size_t>(10, results.size()) << ":\n";
+        for (std::size_t i = 0; i < results.size() && i < 10; ++i)
+        {
+            print(results[i]);
+        }
+        best = results.front();
+    }
+    else
+    {
+        best = evaluate(base, config, pool);
+        print(best);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "\nbest:";
+    print(best);
+    std::cout << "elapsed " << std::setprecision(2) << seconds << " s\n";
+
+    if (!outPath.empty())
+    {
+        if (!Balance::saveFile(outPath, best.params))
+        {
+            std::cerr << "Could not write " << outPath << std::endl;
+            return 1;
+        }
+        std::cout << "written to " << outPath << " (play it with dungeon_crawler --balance " << outPath << ")\n";
+    }
+    return 0;
+}
@@ -0,0 +1,265 @@
+#include "CombatEvents.h"
+#include "EnemyArchetype.h"
+#include "Item.h"
+#include "Snapshot.h"
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Reads a combat event file written with --events (format in CombatEvents.h)
+// and prints every event, or with --summary totals per event type, per enemy
+// type and per dungeon level. --session and --type keep only the events of
+// one game or one kind. Enemy types are named from the built-in table unless
+// --enemies gives the file the games were played with.
+//
+// Usage: event_decoder <events> [--summary] [--session <seed>] [--type <name>] [--enemies <file>]
+
+namespace
+{
+    const char *STATE_NAMES[] = {"main_menu", "exploring", "combat", "shop", "talking_to_npc", "game_over", "victory"};
+
+    std::string stateName(int state)
+    {
+        return state >= 0 && state < static_cast<int>(std::size(STATE_NAMES)) ? STATE_NAMES[state] : std::to_string(state);
+    }
+
+    std::string enemyName(std::uint16_t enemy)
+    {
+        if (enemy == NO_EVENT_ENEMY)
+        {
+            return "-";
+        }
+        if (enemy < NO_ARCHETYPE && EnemyRegistry::isValid(static_cast<EnemyArchetypeId>(enemy)))
+        {
+            return std::string(EnemyRegistry::get(static_cast<EnemyArchetypeId>(enemy)).name);
+        }
+        return std::string("#").append(std::to_string(enemy));
+    }
+
+    std::string itemName(std::uint16_t item)
+    {
+        if (item < NO_ITEM && ItemRegistry::isValid(static_cast<ItemId>(item)))
+        {
+            return std::string(ItemRegistry::get(static_cast<ItemId>(item)).name);
+        }
+        return std::string("#").append(std::to_string(item));
+    }
+
+    void printEvent(const CombatEvent &event)
+    {
+        std::cout << event.session << ' ' << event.sequence << " turn " << event.turn << " level " << event.dungeonLevel
+                  << ' ' << combatEventTypeName(event.type) << ' ';
+        switch (event.type)
+        {
+        case CombatEventType::DAMAGE:
+        case CombatEventType::HEAL:
+            std::cout << (event.actor == EventActor::PLAYER ? "player" : "enemy") << ' ' << event.amount << " -> "
+                      << event.value << " health";
+            break;
+        case CombatEventType::EXPERIENCE:
+            std::cout << event.amount << " -> " << event.value << " xp";
+            break;
+        case CombatEventType::BDP:
+            std::cout << event.amount << " -> " << event.value << " bdp";
+            break;
+        case CombatEventType::ITEM_DROP:
+            std::cout << itemName(event.subject) << " x" << event.amount << " (" << event.value << " held)";
+            break;
+        case CombatEventType::LEVEL_UP:
+            std::cout << "level " << event.value;
+            break;
+        case CombatEventType::STATE_TRANSITION:
+            std::cout << stateName(event.subject) << " -> " << stateName(event.value);
+            break;
+        default:
+            std::cout << event.subject << ' ' << event.amount << ' ' << event.value;
+            break;
+        }
+        std::cout << " [" << enemyName(event.enemy) << "]\n";
+    }
+
+    struct Totals
+    {
+        long long count = 0;
+        long long amount = 0;
+    };
+
+    struct EnemyTotals
+    {
+        long long damageDealt = 0; // By the player, to enemies of this type
+        long long damageTaken = 0; // By the player, from them
+        long long defeated = 0;    // Experience events, one per enemy beaten
+    };
+
+    struct Summary
+    {
+        std::array<Totals, static_cast<std::size_t>(CombatEventType::COUNT)> byType{};
+        std::map<std::uint16_t, EnemyTotals> byEnemy;
+        std::map<std::uint16_t, Totals> damageTakenByLevel;
+        std::map<std::uint64_t, long long> sessions; // Events per session
+        long long events = 0;
+
+        void add(const CombatEvent &event)
+        {
+            ++events;
+            ++sessions[event.session];
+            if (event.type < CombatEventType::COUNT)
+            {
+                Totals &totals = byType[static_cast<std::size_t>(event.type)];
+                ++totals.count;
+                totals.amount += event.amount;
+            }
+            if (event.type == CombatEventType::DAMAGE)
+            {
+                EnemyTotals &enemy = byEnemy[event.enemy];
+                if (event.actor == EventActor::ENEMY)
+                {
+                    enemy.damageDealt += event.amount;
+                }
+                else
+                {
+                    enemy.damageTaken += event.amount;
+                    Totals &level = damageTakenByLevel[event.dungeonLevel];
+                    ++level.count;
+                    level.amount += event.amount;
+                }
+            }
+            else if (event.type == CombatEventType::EXPERIENCE)
+            {
+                ++byEnemy[event.enemy].defeated;
+            }
+        }
+
+        void print() const
+        {
+            std::cout << "Events:   " << events << "\n";
+            std::cout << "Sessions: " << sessions.size() << "\n\n";
+            std::cout << "Type\tCount\tTotal\n";
+            for (std::size_t type = 0; type < byType.size(); ++type)
+            {
+                std::cout << combatEventTypeName(static_cast<CombatEventType>(type)) << '\t' << byType[type].count
+                          << '\t' << byType[type].amount << "\n";
+            }
+            std::cout << "\nEnemy\tDefeated\tDamage dealt\tDamage taken\n";
+            for (const auto &[enemy, totals] : byEnemy)
+            {
+                std::cout << enemyName(enemy) << '\t' << totals.defeated << '\t' << totals.damageDealt << '\t'
+                          << totals.damageTaken << "\n";
+            }
+            std::cout << "\nLevel\tHits taken\tDamage taken\tPer hit\n";
+            for (const auto &[level, totals] : damageTakenByLevel)
+            {
+                std::cout << level << '\t' << totals.count << '\t' << totals.amount << '\t'
+                          << static_cast<double>(totals.amount) / totals.count << "\n";
+            }
+        }
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    std::string path;
+    bool summary = false;
+    bool filterSession = false;
+    std::uint64_t session = 0;
+    bool filterType = false;
+    CombatEventType type = CombatEventType::COUNT;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--summary")
+        {
+            summary = true;
+        }
+        else if (arg == "--session" && i + 1 < argc)
+        {
+            filterSession = true;
+            session = std::stoull(argv[++i]);
+        }
+        else if (arg == "--type" && i + 1 < argc)
+        {
+            std::string name = argv[++i];
+            filterType = true;
+            for (int candidate = 0; candidate < static_cast<int>(CombatEventType::COUNT); ++candidate)
+            {
+                if (combatEventTypeName(static_cast<CombatEventType>(candidate)) == name)
+                {
+                    type = static_cast<CombatEventType>(candidate);
+                }
+            }
+            if (type == CombatEventType::COUNT)
+            {
+                std::cerr << "Unknown event type " << name << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--enemies" && i + 1 < argc)
+        {
+            std::string error;
+            if (!EnemyRegistry::loadFile(argv[++i], error))
+            {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        }
+        else if (path.empty() && arg[0] != '-')
+        {
+            path = arg;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " <events> [--summary] [--session <seed>] [--type <name>] [--enemies <file>]" << std::endl;
+            return 1;
+        }
+    }
+    if (path.empty())
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <events> [--summary] [--session <seed>] [--type <name>] [--enemies <file>]" << std::endl;
+        return 1;
+    }
+
+    MappedFile file(path);
+    if (!file.isOpen())
+    {
+        std::cerr << "cannot read " << path << " (missing or empty)" << std::endl;
+        return 1;
+    }
+
+    Summary totals;
+    CombatEventReader reader(file.getData(), file.getSize());
+    for (auto block = reader.nextBlock(); !block.empty(); block = reader.nextBlock()) // Games never write empty blocks
+    {
+        for (const CombatEvent &event : block)
+        {
+            if ((filterSession && event.session != session) || (filterType && event.type != type))
+            {
+                continue;
+            }
+            if (summary)
+            {
+                totals.add(event);
+            }
+            else
+            {
+                printEvent(event);
+            }
+        }
+    }
+    if (summary)
+    {
+        totals.print();
+    }
+    std::cout.flush();
+
+    if (reader.isDamaged())
+    {
+        std::cerr << path << ": stopped at a damaged block at byte " << reader.getOffset() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "Dialogue.h"
+#include "Snapshot.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Compiles dialogue source text into a corpus file the game maps read-only
+// (format in Dialogue.h).
+// Usage: dialogue_compiler <source.txt> <corpus.dcd>
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <source.txt> <corpus.dcd>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input)
+    {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::stringstream source;
+    source << input.rdbuf();
+
+    std::vector<char> corpus;
+    std::string error;
+    if (!DialogueCorpus::compile(source.str(), corpus, error))
+    {
+        std::cerr << argv[1] << ": " << error << std::endl;
+        return 1;
+    }
+    if (!writeSnapshotFile(argv[2], corpus))
+    {
+        std::cerr << "could not write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::string check;
+    if (!DialogueCorpus::loadFile(argv[2], check))
+    {
+        std::cerr << check << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << argv[2] << ": " << DialogueCorpus::lineCount() << " lines, "
+              << corpus.size() << " bytes" << std::endl;
+    return 0;
+}